@@ -0,0 +1,202 @@
+#include "bench.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> numAllocs{0};
+static std::atomic<uint64_t> numBytes {0};
+
+void* operator new(size_t sz) {
+  numAllocs.fetch_add(1,std::memory_order_relaxed);
+  numBytes .fetch_add(sz,std::memory_order_relaxed);
+  if(void* p = std::malloc(sz==0 ? 1 : sz))
+    return p;
+  throw std::bad_alloc();
+  }
+
+void* operator new[](size_t sz) {
+  return ::operator new(sz);
+  }
+
+void* operator new(size_t sz, const std::nothrow_t&) noexcept {
+  numAllocs.fetch_add(1,std::memory_order_relaxed);
+  numBytes .fetch_add(sz,std::memory_order_relaxed);
+  return std::malloc(sz==0 ? 1 : sz);
+  }
+
+void* operator new[](size_t sz, const std::nothrow_t& t) noexcept {
+  return ::operator new(sz,t);
+  }
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+  }
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+  }
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+  }
+
+void operator delete[](void* p, size_t) noexcept {
+  std::free(p);
+  }
+
+Bench::Bench(std::string_view filter, uint64_t minTimeMs)
+  :filter(filter), minTime(minTimeMs*1000000) {
+  }
+
+uint64_t Bench::allocCount() {
+  return numAllocs.load(std::memory_order_relaxed);
+  }
+
+uint64_t Bench::allocBytes() {
+  return numBytes.load(std::memory_order_relaxed);
+  }
+
+uint64_t Bench::timeNs() {
+  using namespace std::chrono;
+  return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+
+bool Bench::isEnabled(std::string_view name) const {
+  return filter.empty() || name.find(filter)!=std::string_view::npos;
+  }
+
+void Bench::skip(std::string_view name, std::string_view reason) {
+  if(!isEnabled(name))
+    return;
+  Result r;
+  r.name    = name;
+  r.skipped = reason;
+  results.push_back(std::move(r));
+  }
+
+void Bench::counter(std::string_view name, double value, std::string_view unit) {
+  if(!isEnabled(name))
+    return;
+  Result r;
+  r.name  = name;
+  r.value = value;
+  r.unit  = unit;
+  results.push_back(std::move(r));
+
+  auto& c = results.back();
+  std::fprintf(stderr,"%-48s %14.1f %s\n",c.name.c_str(),c.value,c.unit.c_str());
+  }
+
+void Bench::check(std::string_view name, bool ok, std::string_view reason) {
+  if(!isEnabled(name))
+    return;
+  Result r;
+  r.name    = name;
+  r.isCheck = true;
+  r.failed  = ok ? "" : reason;
+  results.push_back(std::move(r));
+
+  auto& c = results.back();
+  if(c.failed.empty())
+    std::fprintf(stderr,"%-48s ok\n",c.name.c_str()); else
+    std::fprintf(stderr,"%-48s FAILED: %s\n",c.name.c_str(),c.failed.c_str());
+  }
+
+void Bench::checkNoAllocs(std::string_view name) {
+  for(auto& r:results) {
+    if(r.name!=name || r.isCheck || !r.skipped.empty() || !r.unit.empty())
+      continue;
+    char buf[64] = {};
+    std::snprintf(buf,sizeof(buf),"%.2f allocs/op",r.allocPerOp);
+    check(std::string(name).append(" [no allocs]"),r.allocPerOp==0,buf);
+    return;
+    }
+  }
+
+size_t Bench::failures() const {
+  size_t n = 0;
+  for(auto& r:results)
+    if(!r.failed.empty())
+      ++n;
+  return n;
+  }
+
+void Bench::submit(std::string_view name, std::vector<Batch>& batches) {
+  Result r;
+  r.name = name;
+
+  uint64_t allocs = 0, bytes = 0;
+  for(auto& b:batches) {
+    r.iterations += b.iterations;
+    allocs       += b.allocs;
+    bytes        += b.bytes;
+    }
+  std::sort(batches.begin(),batches.end(),[](const Batch& a, const Batch& b){
+    return a.ns*b.iterations < b.ns*a.iterations;
+    });
+  auto nsPerOp = [](const Batch& b) { return double(b.ns)/double(b.iterations); };
+  r.nsPerOp    = nsPerOp(batches[batches.size()/2]);
+  r.nsPerOpMin = nsPerOp(batches.front());
+  r.allocPerOp = double(allocs)/double(r.iterations);
+  r.bytesPerOp = double(bytes) /double(r.iterations);
+  results.push_back(std::move(r));
+
+  auto& b = results.back();
+  std::fprintf(stderr,"%-48s %14.1f ns/op %10.1f allocs/op %12.1f B/op (%llu iterations)\n",
+               b.name.c_str(), b.nsPerOp, b.allocPerOp, b.bytesPerOp, static_cast<unsigned long long>(b.iterations));
+  }
+
+void Bench::print() const {
+  for(auto& r:results) {
+    if(!r.skipped.empty())
+      std::fprintf(stderr,"%-48s skipped: %s\n",r.name.c_str(),r.skipped.c_str());
+    if(!r.failed.empty())
+      std::fprintf(stderr,"%-48s FAILED: %s\n",r.name.c_str(),r.failed.c_str());
+    }
+  }
+
+static void writeEscaped(FILE* f, std::string_view s) {
+  for(auto c:s) {
+    if(c=='"' || c=='\\')
+      std::fputc('\\',f);
+    std::fputc(c,f);
+    }
+  }
+
+bool Bench::writeJson(std::string_view file) const {
+  FILE* f = file.empty() ? stdout : std::fopen(std::string(file).c_str(),"wb");
+  if(f==nullptr)
+    return false;
+
+  std::fprintf(f,"{\n  \"benchmarks\": [\n");
+  for(size_t i=0; i<results.size(); ++i) {
+    auto& r = results[i];
+    std::fprintf(f,"    {\"name\": \"");
+    writeEscaped(f,r.name);
+    if(!r.skipped.empty()) {
+      std::fprintf(f,"\", \"skipped\": \"");
+      writeEscaped(f,r.skipped);
+      std::fprintf(f,"\"}");
+      } else if(r.isCheck) {
+      std::fprintf(f,"\", \"passed\": %s, \"reason\": \"",r.failed.empty() ? "true" : "false");
+      writeEscaped(f,r.failed);
+      std::fprintf(f,"\"}");
+      } else if(!r.unit.empty()) {
+      std::fprintf(f,"\", \"value\": %.1f, \"unit\": \"",r.value);
+      writeEscaped(f,r.unit);
+      std::fprintf(f,"\"}");
+      } else {
+      std::fprintf(f,"\", \"iterations\": %llu, \"ns_per_op\": %.1f, \"ns_per_op_min\": %.1f, "
+                     "\"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}",
+                   static_cast<unsigned long long>(r.iterations), r.nsPerOp, r.nsPerOpMin, r.allocPerOp, r.bytesPerOp);
+      }
+    std::fprintf(f,"%s\n", i+1<results.size() ? "," : "");
+    }
+  std::fprintf(f,"  ]\n}\n");
+
+  if(f!=stdout)
+    std::fclose(f);
+  return true;
+  }
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// minimal benchmark harness: ns/op and heap allocations/op, json report
+class Bench final {
+  public:
+    Bench(std::string_view filter, uint64_t minTimeMs);
+
+    struct Result final {
+      std::string name;
+      uint64_t    iterations  = 0;
+      double      nsPerOp     = 0;  // median of batches
+      double      nsPerOpMin  = 0;
+      double      allocPerOp  = 0;
+      double      bytesPerOp  = 0;
+      std::string skipped;
+      bool        isCheck     = false;
+      std::string failed;       // reason, for failed checks
+      std::string unit;         // non-empty for counters
+      double      value       = 0;
+      };
+
+    bool isEnabled(std::string_view name) const;
+
+    template<class F>
+    void run(std::string_view name, F&& op);
+    void skip(std::string_view name, std::string_view reason);
+    void counter(std::string_view name, double value, std::string_view unit);
+    // correctness checks: any failure makes bench exit with non-zero code
+    void check(std::string_view name, bool ok, std::string_view reason);
+    void checkNoAllocs(std::string_view name);
+    size_t failures() const;
+
+    bool writeJson(std::string_view file) const;
+    void print() const;
+
+    static uint64_t allocCount();
+    static uint64_t allocBytes();
+
+  private:
+    struct Batch final {
+      uint64_t iterations = 0;
+      uint64_t ns         = 0;
+      uint64_t allocs     = 0;
+      uint64_t bytes      = 0;
+      };
+
+    static uint64_t     timeNs();
+    void                submit(std::string_view name, std::vector<Batch>& batches);
+
+    std::string         filter;
+    uint64_t            minTime = 0;
+    std::vector<Result> results;
+  };
+
+template<class F>
+void Bench::run(std::string_view name, F&& op) {
+  if(!isEnabled(name))
+    return;
+
+  // warm-up: also gives first estimate of op cost
+  uint64_t t0 = timeNs();
+  op();
+  uint64_t first = std::max<uint64_t>(timeNs()-t0,1);
+
+  // aim for ~10 batches, each at least one op
+  const uint64_t batchTime = std::max<uint64_t>(minTime/10,1);
+  const uint64_t perBatch  = std::max<uint64_t>(batchTime/first,1);
+
+  std::vector<Batch> batches;
+  uint64_t total = 0;
+  while(total<minTime || batches.size()<3) {
+    Batch b;
+    const uint64_t a0 = allocCount();
+    const uint64_t m0 = allocBytes();
+    const uint64_t s  = timeNs();
+    for(uint64_t i=0; i<perBatch; ++i)
+      op();
+    b.ns         = timeNs()-s;
+    b.allocs     = allocCount()-a0;
+    b.bytes      = allocBytes()-m0;
+    b.iterations = perBatch;
+    total += b.ns;
+    batches.push_back(b);
+    }
+  submit(name,batches);
+  }
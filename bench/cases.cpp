@@ -0,0 +1,490 @@
+#include "cases.h"
+
+#include <Tempest/File>
+#include <Tempest/MemReader>
+#include <Tempest/MemWriter>
+#include <Tempest/Pixmap>
+#include <Tempest/TextCodec>
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "bench.h"
+
+#include "bink/video.h"
+#include "dmusic/mixer.h"
+#include "dmusic/music.h"
+#include "game/compatibility/mem32.h"
+#include "game/definitions/musicdefinitions.h"
+#include "game/gamesession.h"
+#include "game/serialize.h"
+#include "graphics/dynamic/frustrum.h"
+#include "graphics/dynamic/visibilitygroup.h"
+#include "graphics/dynamic/visibleset.h"
+#include "graphics/mesh/submesh/packedmesh.h"
+#include "graphics/mesh/animationsolver.h"
+#include "graphics/mesh/pose.h"
+#include "graphics/mesh/skeleton.h"
+#include "graphics/worldview.h"
+#include "world/aiqueue.h"
+#include "world/nameindex.h"
+#include "world/objects/item.h"
+#include "world/objects/npc.h"
+#include "world/objects/pfxemitter.h"
+#include "world/spaceindex.h"
+#include "world/waymatrix.h"
+#include "world/world.h"
+#include "utils/fileutil.h"
+#include "gothic.h"
+#include "resources.h"
+
+using namespace Tempest;
+
+// fixed seed: runs must be comparable between builds
+static std::mt19937 mkRandom() {
+  return std::mt19937(42);
+  }
+
+void benchVisibilityGroup(Bench& b) {
+  const size_t count = 16*1024;
+  const float  range = 100000.f;
+
+  auto rng = mkRandom();
+  std::uniform_real_distribution<float> pos(-range,range), sz(50.f,500.f);
+
+  VisibilityGroup vg({Vec3(-range,-range,-range),Vec3(range,range,range)});
+  std::vector<VisibleSet>             sets(count/VisibleSet::CAPACITY+1);
+  std::vector<VisibilityGroup::Token> tok;
+  tok.reserve(count);
+  for(size_t i=0; i<count; ++i) {
+    auto   t = vg.get(i%8==0 ? VisibilityGroup::G_Default : VisibilityGroup::G_Static);
+    Bounds bbox;
+    bbox.assign(Vec3(0,0,0),sz(rng));
+    t.setObject(&sets[i/VisibleSet::CAPACITY],i%VisibleSet::CAPACITY);
+    t.setBounds(bbox);
+
+    Matrix4x4 mt;
+    mt.identity();
+    mt.translate(pos(rng),pos(rng)*0.1f,pos(rng));
+    t.setObjMatrix(mt);
+    tok.emplace_back(std::move(t));
+    }
+
+  Frustrum fr[SceneGlobals::V_Count];
+  for(uint8_t i=0; i<SceneGlobals::V_Count; ++i) {
+    Matrix4x4 proj, view;
+    proj.perspective(65.f, 16.f/9.f, 10.f, 100000.f);
+    view.identity();
+    view.rotateOY(float(i)*45.f);
+    proj.mul(view);
+    fr[i].make(proj,1920,1080);
+    }
+
+  auto reset = [&sets]() {
+    for(auto& s:sets)
+      s.reset();
+    };
+
+  vg.pass(fr);
+  b.run("VisibilityGroup::pass", [&]() {
+    reset();
+    vg.pass(fr);
+    });
+
+  size_t     id = 0;
+  Matrix4x4  mt;
+  mt.identity();
+  b.run("VisibilityGroup::buildTree+pass", [&]() {
+    // moving any static token invalidates the tree
+    tok[(id++)*8%count+1].setObjMatrix(mt);
+    reset();
+    vg.pass(fr);
+    });
+  }
+
+void benchSerializePrimitives(Bench& b) {
+  std::vector<uint8_t> data;
+  const std::string    name = "benchmark_entry";
+
+  b.run("Serialize::write", [&]() {
+    data.clear();
+    MemWriter wr{data};
+    Serialize fout{wr};
+    fout.setEntry("bench/data");
+    for(uint32_t i=0; i<4096; ++i)
+      fout.write(i,float(i),Vec3(float(i),0,1),name);
+    });
+
+  b.run("Serialize::read", [&]() {
+    MemReader rd{data};
+    Serialize fin{rd};
+    fin.setEntry("bench/data");
+    uint32_t    u = 0;
+    float       f = 0;
+    Vec3        v;
+    std::string s;
+    for(uint32_t i=0; i<4096; ++i)
+      fin.read(u,f,v,s);
+    });
+  }
+
+void benchAiQueue(Bench& b) {
+  AiQueue queue;
+
+  // typical routine loop, as pushed by scripts; must not allocate after warm-up
+  b.run("AiQueue::push/pop(routine)", [&]() {
+    for(int i=0; i<4; ++i) {
+      queue.pushBack(AiQueue::aiSetWalkMode(WalkBit::WM_Walk));
+      queue.pushBack(AiQueue::aiGoToNextFp("STAND"));
+      queue.pushBack(AiQueue::aiAlignToFp());
+      queue.pushBack(AiQueue::aiPlayAnim("T_STAND_2_HGUARD"));
+      queue.pushBack(AiQueue::aiUseMob("BENCH",1));
+      queue.pushBack(AiQueue::aiWait(1000));
+      queue.pushBack(AiQueue::aiUseMob("BENCH",-1));
+      queue.pushFront(AiQueue::aiStandup());
+      }
+    while(queue.size()>0)
+      queue.pop();
+    });
+  b.checkNoAllocs("AiQueue::push/pop(routine)");
+  }
+
+void benchMem32(Bench& b) {
+  Mem32 mem;
+  auto  rng = mkRandom();
+
+  // heap of ikarus-based mod: mostly small blocks, some arrays
+  struct Rgn {
+    Mem32::ptr32_t address = 0;
+    uint32_t       size    = 0;
+    };
+  std::vector<Rgn> rgn(4096);
+  for(auto& r:rgn) {
+    r.size    = (rng()%16==0) ? uint32_t(4096+rng()%16384) : uint32_t(8+rng()%248);
+    r.address = mem.alloc(r.size);
+    }
+
+  std::vector<Mem32::ptr32_t> at(4096);
+  for(auto& a:at) {
+    auto& r = rgn[rng()%rgn.size()];
+    a = r.address + (uint32_t(rng())%(r.size/4))*4;
+    }
+
+  b.run("Mem32::readInt/writeInt(4096 regions)", [&]() {
+    int32_t sum = 0;
+    for(size_t i=0; i<at.size(); i+=2) {
+      mem.writeInt(at[i],sum);
+      sum += mem.readInt(at[i+1]);
+      }
+    (void)sum;
+    });
+
+  size_t id = 0;
+  b.run("Mem32::free/alloc(4096 regions)", [&]() {
+    auto& r = rgn[(id++)%rgn.size()];
+    mem.free(r.address);
+    r.address = mem.alloc(r.size);
+    });
+  }
+
+void benchNameIndex(Bench& b) {
+  struct Obj {
+    std::string name;
+    };
+  auto rng = mkRandom();
+
+  // vob names repeat in real worlds (triggers, FP_* free points), in mixed case
+  std::vector<Obj> obj(2048);
+  for(auto& o:obj) {
+    char buf[32] = {};
+    std::snprintf(buf,sizeof(buf),"%s_%u",(rng()%2) ? "Fp_Roam" : "EVT_TRIGGER",unsigned(rng()%512));
+    o.name = buf;
+    if(rng()%2)
+      for(auto& c:o.name)
+        c = char(std::toupper(c));
+    }
+
+  NameIndex<const Obj> index;
+  for(auto& o:obj)
+    index.insert(o.name,&o);
+
+  auto equal = [](std::string_view a, std::string_view b) {
+    if(a.size()!=b.size())
+      return false;
+    for(size_t i=0; i<a.size(); ++i)
+      if(std::toupper(a[i])!=std::toupper(b[i]))
+        return false;
+    return true;
+    };
+
+  // reference: linear scan in order of insertion, as lookups did before the index
+  bool first = true, all = true;
+  for(auto& o:obj) {
+    std::string query = o.name;
+    for(auto& c:query)
+      c = char(std::tolower(c));
+
+    std::vector<const Obj*> expect;
+    for(auto& i:obj)
+      if(equal(i.name,query))
+        expect.push_back(&i);
+    first &= (index.find(query)==expect.front());
+    all   &= (index.findAll(query)==expect);
+    }
+  first &= (index.find("NO_SUCH_NAME")==nullptr);
+  b.check("NameIndex::find(duplicates, first match)",first,"not the first inserted object");
+  b.check("NameIndex::findAll(duplicates, insertion order)",all,"order of objects differs");
+
+  size_t id = 0;
+  b.run("NameIndex::find", [&]() {
+    auto p = index.find(obj[(id++)%obj.size()].name);
+    (void)p;
+    });
+  }
+
+void benchPackedMesh(Bench& b, const phoenix::mesh& mesh) {
+  b.run("PackedMesh(landscape, PK_VisualLnd)", [&]() {
+    PackedMesh pk(mesh,PackedMesh::PK_VisualLnd);
+    });
+  b.run("PackedMesh(landscape, PK_Physic)", [&]() {
+    PackedMesh pk(mesh,PackedMesh::PK_Physic);
+    });
+  }
+
+void benchWayMatrix(Bench& b, World& world, const phoenix::way_net& net) {
+  WayMatrix wm(world,net);
+  wm.buildIndex();
+
+  std::vector<const WayPoint*> wp;
+  for(auto& i:net.waypoints)
+    if(auto p = wm.findPoint(i.name,false))
+      wp.push_back(p);
+  if(wp.size()<2) {
+    b.skip("WayMatrix::wayTo","no waypoints");
+    return;
+    }
+
+  auto rng = mkRandom();
+  std::vector<std::pair<const WayPoint*,const WayPoint*>> query(1024);
+  for(auto& q:query)
+    q = {wp[rng()%wp.size()], wp[rng()%wp.size()]};
+
+  size_t id = 0;
+  b.run("WayMatrix::wayTo", [&]() {
+    auto& q = query[(id++)%query.size()];
+    auto  p = wm.wayTo(*q.first,*q.second);
+    (void)p;
+    });
+  }
+
+void benchSpaceIndex(Bench& b, World& world) {
+  std::vector<Vec3> at;
+  for(uint32_t i=0; i<world.npcCount(); ++i)
+    at.push_back(world.npcById(i)->position());
+  if(at.empty()) {
+    b.skip("BaseSpaceIndex::find","no npc in world");
+    return;
+    }
+
+  size_t id  = 0;
+  size_t cnt = 0;
+  b.run("BaseSpaceIndex::find(items, R=1000)", [&]() {
+    world.detectItem(at[(id++)%at.size()],1000.f,[&cnt](Item&){ ++cnt; });
+    });
+
+  // item traffic of busy scene: per tick 2 items are picked up, 2 dropped, one moved and 4 queries are made
+  std::vector<Item*> in, out;
+  for(uint32_t i=0; world.itmById(i)!=nullptr; ++i)
+    in.push_back(world.itmById(i));
+  if(in.size()<16) {
+    b.skip("BaseSpaceIndex churn","not enough items in world");
+    return;
+    }
+
+  auto             rng = mkRandom();
+  SpaceIndex<Item> index;
+  for(auto i:in)
+    index.add(i);
+
+  auto tick = [&]() {
+    for(int i=0; i<2; ++i) {
+      size_t k = rng()%in.size();
+      index.del(in[k]);
+      out.push_back(in[k]);
+      in[k] = in.back();
+      in.pop_back();
+      }
+    for(int i=0; i<2; ++i) {
+      size_t k = rng()%out.size();
+      index.add(out[k]);
+      in.push_back(out[k]);
+      out[k] = out.back();
+      out.pop_back();
+      }
+    index.invalidate(in[rng()%in.size()]);
+    for(int i=0; i<4; ++i)
+      index.find(at[(id++)%at.size()],1000.f,[&cnt](Item&){ ++cnt; });
+    };
+
+  const uint64_t rebuilds = index.rebuildCount();
+  for(int i=0; i<1000; ++i)
+    tick();
+  b.counter("BaseSpaceIndex churn: rebuilds",double(index.rebuildCount()-rebuilds),"per 1000 ticks");
+  b.run("BaseSpaceIndex churn: tick",tick);
+  }
+
+void benchPose(Bench& b) {
+  auto sk = Resources::loadSkeleton("HUMANS.MDS");
+  if(sk==nullptr) {
+    b.skip("Pose::update","HUMANS.MDS not found");
+    return;
+    }
+  AnimationSolver solver;
+  solver.setSkeleton(sk);
+
+  auto sq = solver.solveFrm("S_RUNL");
+  if(sq==nullptr) {
+    b.skip("Pose::update","S_RUNL not found");
+    return;
+    }
+
+  Matrix4x4 mt;
+  mt.identity();
+
+  const size_t      count = 64;
+  std::vector<Pose> pose(count);
+  uint64_t          tick = 1;
+  for(auto& p:pose) {
+    p.setSkeleton(sk);
+    p.startAnim(solver,sq,0,BS_NONE,Pose::NoHint,tick);
+    p.setObjectMatrix(mt,false);
+    }
+
+  b.run("Pose::update(64 poses)", [&]() {
+    tick += 16;
+    for(auto& p:pose)
+      p.update(tick);
+    });
+  }
+
+void benchPfx(Bench& b, World& world) {
+  auto wview = world.view();
+  auto pl    = world.player();
+  if(wview==nullptr || pl==nullptr) {
+    b.skip("WorldView::preFrameUpdate(pfx)","world has no view");
+    return;
+    }
+
+  auto rng = mkRandom();
+  std::uniform_real_distribution<float> pos(-1000.f,1000.f);
+
+  std::vector<PfxEmitter> emitters;
+  for(size_t i=0; i<256; ++i) {
+    PfxEmitter e(world,"FIRE_SMOKE");
+    e.setPosition(pl->position()+Vec3(pos(rng),0,pos(rng)));
+    e.setActive(true);
+    e.setLooped(true);
+    emitters.emplace_back(std::move(e));
+    }
+
+  Matrix4x4 view, proj, shadow[Resources::ShadowLayers];
+  view.identity();
+  proj.perspective(65.f, 16.f/9.f, 10.f, 100000.f);
+  for(auto& s:shadow)
+    s.identity();
+
+  uint64_t tick = world.tickCount();
+  uint8_t  fId  = 0;
+  b.run("WorldView::preFrameUpdate(pfx)", [&]() {
+    tick += 16;
+    fId   = uint8_t((fId+1)%Resources::MaxFramesInFlight);
+    wview->preFrameUpdate(view,proj,10.f,100000.f,shadow,tick,fId);
+    });
+  }
+
+void benchMixer(Bench& b) {
+  auto theme = Gothic::musicDef()["SYS_MENU"];
+  if(theme==nullptr) {
+    b.skip("Dx8::Mixer::mix","SYS_MENU theme not found");
+    return;
+    }
+
+  Dx8::PatternList p = Resources::loadDxMusic(theme->file);
+  Dx8::Music       m;
+  m.addPattern(p);
+
+  Dx8::Mixer mix;
+  mix.setMusic(m);
+
+  // one 44.1kHz stereo buffer, same size as used by sound device
+  std::vector<int16_t> pcm(2*2048);
+  b.run("Dx8::Mixer::mix(2048 samples)", [&]() {
+    mix.mix(pcm.data(),pcm.size()/2);
+    });
+  }
+
+namespace {
+struct MemInput : Bink::Video::Input {
+  explicit MemInput(const std::vector<uint8_t>& data):data(data) {}
+
+  void read(void* dest, size_t count) override {
+    if(at+count>data.size())
+      throw std::runtime_error("i/o error");
+    std::memcpy(dest,data.data()+at,count);
+    at += count;
+    }
+  void skip(size_t count) override { at += count; }
+  void seek(size_t pos)   override { at  = pos;   }
+
+  const std::vector<uint8_t>& data;
+  size_t                      at = 0;
+  };
+}
+
+void benchBink(Bench& b, std::string_view video) {
+  auto path  = Gothic::inst().nestedPath({u"_work",u"Data",u"Video"},Dir::FT_Dir);
+  auto fname = TextCodec::toUtf16(std::string(video)+".bik");
+  auto file  = FileUtil::caseInsensitiveSegment(path,fname.c_str(),Dir::FT_File);
+
+  std::vector<uint8_t> data;
+  try {
+    RFile fin(file);
+    data.resize(fin.size());
+    fin.read(data.data(),data.size());
+    }
+  catch(...) {
+    b.skip("Bink::Video::nextFrame","video not found");
+    return;
+    }
+
+  MemInput                     in(data);
+  std::unique_ptr<Bink::Video> vid(new Bink::Video(&in));
+  b.run("Bink::Video::nextFrame", [&]() {
+    if(vid->currentFrame()>=vid->frameCount()) {
+      vid.reset();
+      in.at = 0;
+      vid.reset(new Bink::Video(&in));
+      }
+    vid->nextFrame();
+    });
+  }
+
+void benchSession(Bench& b) {
+  std::vector<uint8_t> data;
+
+  b.run("GameSession::save", [&]() {
+    data.clear();
+    MemWriter wr{data};
+    Serialize fout{wr};
+    Gothic::inst().world()->gameSession().save(fout,"benchmark",Pixmap());
+    });
+
+  b.run("GameSession::load", [&]() {
+    Gothic::inst().setGame(std::unique_ptr<GameSession>());
+    MemReader rd{data};
+    Serialize fin{rd};
+    Gothic::inst().setGame(std::unique_ptr<GameSession>(new GameSession(fin)));
+    });
+  }
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string_view>
+
+#include <phoenix/world.hh>
+
+class Bench;
+class World;
+
+// synthetic, no game assets required
+void benchVisibilityGroup(Bench& b);
+void benchSerializePrimitives(Bench& b);
+void benchAiQueue            (Bench& b);
+void benchMem32              (Bench& b);
+void benchNameIndex          (Bench& b);
+
+// require game assets
+void benchPackedMesh(Bench& b, const phoenix::mesh& mesh);
+void benchWayMatrix (Bench& b, World& world, const phoenix::way_net& net);
+void benchSpaceIndex(Bench& b, World& world);
+void benchPose      (Bench& b);
+void benchPfx       (Bench& b, World& world);
+void benchMixer     (Bench& b);
+void benchBink      (Bench& b, std::string_view video);
+void benchSession   (Bench& b);
@@ -0,0 +1,131 @@
+#include <Tempest/Log>
+#include <Tempest/VulkanApi>
+
+#include <cstring>
+
+#include "bench.h"
+#include "cases.h"
+
+#include "game/gamesession.h"
+#include "graphics/shaders.h"
+#include "commandline.h"
+#include "gamemusic.h"
+#include "gothic.h"
+#include "resources.h"
+
+using namespace Tempest;
+
+/*
+  opengothic_bench [-bench-filter <substr>] [-bench-time <ms>] [-bench-out <file.json>] [-bench-video <name>]
+                   [game command line: -g <path>, -w <world.zen>, -headless, ...]
+
+  synthetic benchmarks always run; the rest needs a gothic installation
+  exit code is non-zero, if any correctness check has failed
+  results are written to bench.json by default; "-bench-out -" writes to stdout
+*/
+
+static const char* selectDevice(const AbstractGraphicsApi& api) {
+  static Device::Props p;
+  auto d = api.devices();
+  for(auto& i:d)
+    if(i.type==DeviceType::Discrete) {
+      p = i;
+      return p.name;
+      }
+  if(d.size()>0) {
+    p = d[0];
+    return p.name;
+    }
+  return nullptr;
+  }
+
+static phoenix::world loadZen(std::string_view name) {
+  auto entry = Resources::vdfsIndex().find_entry(name);
+  if(entry==nullptr)
+    throw std::runtime_error("unable to open Zen-file");
+  auto buf = entry->open();
+  return phoenix::world::parse(buf, Gothic::inst().version().game==1 ? phoenix::game_version::gothic_1
+                                                                      : phoenix::game_version::gothic_2);
+  }
+
+static void benchEngine(Bench& bench, int argc, const char** argv, std::string_view video) {
+  CommandLine cmd{argc,argv};
+  VulkanApi   api{ApiFlags::NoFlags};
+  Device      device{api,selectDevice(api)};
+  Resources   resources{device};
+
+  Gothic      gothic;
+  GameMusic   music;
+  gothic.setupGlobalScripts();
+
+  benchMixer(bench);
+  benchBink (bench,video);
+
+  // WorldView requires shaders; not needed for headless world
+  std::unique_ptr<Shaders> shaders;
+  if(!gothic.isHeadless())
+    shaders.reset(new Shaders());
+
+  gothic.setGame(std::unique_ptr<GameSession>(new GameSession(std::string(gothic.defaultWorld()))));
+  auto world = gothic.world();
+  if(world==nullptr)
+    throw std::runtime_error("unable to load world");
+  for(int i=0; i<60; ++i)
+    gothic.tick(16);
+
+  {
+    auto zen = loadZen(world->name());
+    benchPackedMesh(bench,zen.world_mesh);
+    benchWayMatrix (bench,*world,zen.world_way_net);
+  }
+  benchSpaceIndex(bench,*world);
+  benchPose      (bench);
+  benchPfx       (bench,*world);
+  benchSession   (bench);
+
+  gothic.setGame(std::unique_ptr<GameSession>());
+  shaders.reset();
+  device.waitIdle();
+  }
+
+int main(int argc, const char** argv) {
+  std::string_view filter, out = "bench.json", video = "INTRO";
+  uint64_t         minTime = 500;
+  for(int i=1; i+1<argc; ++i) {
+    std::string_view arg = argv[i];
+    if(arg=="-bench-filter")
+      filter = argv[++i];
+    else if(arg=="-bench-time")
+      minTime = std::strtoull(argv[++i],nullptr,10);
+    else if(arg=="-bench-out")
+      out = argv[++i];
+    else if(arg=="-bench-video")
+      video = argv[++i];
+    }
+
+  Bench bench(filter,minTime);
+  benchVisibilityGroup    (bench);
+  benchSerializePrimitives(bench);
+  benchAiQueue            (bench);
+  benchMem32              (bench);
+  benchNameIndex          (bench);
+
+  try {
+    benchEngine(bench,argc,argv,video);
+    }
+  catch(const std::exception& e) {
+    Log::e("bench: ",e.what());
+    bench.skip("engine",e.what());
+    }
+
+  bench.print();
+  if(!bench.writeJson(out=="-" ? "" : out)) {
+    Log::e("bench: unable to write \"",out,"\"");
+    return 1;
+    }
+  if(bench.failures()>0) {
+    Log::e("bench: ",bench.failures()," check(s) failed");
+    return 1;
+    }
+  return 0;
+  }
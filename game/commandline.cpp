@@ -3,6 +3,8 @@
 #include <Tempest/Log>
 #include <Tempest/TextCodec>
 #include <cstring>
+#include <cctype>
+#include <algorithm>
 
 #include "gothic.h"
 
@@ -81,6 +83,31 @@ CommandLine::CommandLine(int argc, const char** argv) {
     else if(arg=="-respawn") {
       respawn  = true;
       }
+    else if(arg=="-profile") {
+      ++i;
+      if(i<argc)
+        profDef = argv[i];
+      }
+    else if(arg=="-profile-script") {
+      profScr  = true;
+      }
+    else if(arg=="-headless") {
+      headless = true;
+      if(i+1<argc && std::isdigit(uint8_t(argv[i+1][0]))) {
+        ++i;
+        hlTicks = uint32_t(std::strtoul(argv[i],nullptr,10));
+        }
+      }
+    else if(arg=="-dt") {
+      ++i;
+      if(i<argc)
+        hlDt = std::max(1u,uint32_t(std::strtoul(argv[i],nullptr,10)));
+      }
+    else if(arg=="-until") {
+      ++i;
+      if(i<argc)
+        hlUntil = argv[i];
+      }
     }
 
   if(gpath.empty()) {
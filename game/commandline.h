@@ -32,6 +32,13 @@ class CommandLine {
     bool                doForceG2()     const { return forceG2;  }
     bool                doRespawn()     const { return respawn;  }
     std::string_view    defaultSave()   const { return saveDef;  }
+    std::string_view    profileFile()   const { return profDef;  }
+    bool                isScriptProfile() const { return profScr; }
+
+    bool                isHeadless()    const { return headless; }
+    uint32_t            headlessTicks() const { return hlTicks;  }
+    uint32_t            headlessDt()    const { return hlDt;     }
+    std::string_view    headlessUntil() const { return hlUntil;  }
 
     std::string         wrldDef;
     bool                noFrate = false;
@@ -42,6 +49,8 @@ class CommandLine {
     GraphicBackend      graphics = GraphicBackend::Vulkan;
     std::u16string      gpath, gscript, gmod;
     std::string         saveDef;
+    std::string         profDef;
+    std::string         hlUntil;
     bool                noMenu   = false;
     bool                isWindow = false;
     bool                isDebug  = false;
@@ -54,5 +63,9 @@ class CommandLine {
     bool                forceG1  = false;
     bool                forceG2  = false;
     bool                respawn  = false;
+    bool                profScr  = false;
+    bool                headless = false;
+    uint32_t            hlTicks  = 1000;
+    uint32_t            hlDt     = 1000/60;
   };
 
@@ -12,12 +12,13 @@ Mem32::Mem32() {
    *  [0x80000000 .. 0xc0000000] - (1GB) extra space(reserved for opengothic use; pinned memory)
    *  [0xc0000000 .. 0xffffffff] - (1GB) kernel space
    */
-  region.emplace_back(Region(0x1000,0x80000000));
+  insertRun(0x1000 >> PageBits, (0x80000000 - 0x1000) >> PageBits);
+  pinNext = 0x80000000;
   }
 
 Mem32::~Mem32() {
-  for(auto& rgn:region) {
-    if(rgn.status==S_Allocated && rgn.real!=nullptr) {
+  for(auto& rgn:large) {
+    if(rgn.real!=nullptr) {
       std::free(rgn.real);
       rgn.real = nullptr;
       }
@@ -25,159 +26,329 @@ Mem32::~Mem32() {
   }
 
 Mem32::ptr32_t Mem32::pin(void* mem, ptr32_t address, uint32_t size, const char* comment) {
-  for(size_t i=0; i<region.size(); ++i) {
-    auto& rgn = region[i];
-
-    if(address!=0) {
-      if(!(rgn.address<=address && address+size<=rgn.address+rgn.size))
-        continue;
-      } else {
-      if(rgn.size<size)
-        continue;
+  const uint32_t sz = std::max<uint32_t>(size,1);
+  if(address==0) {
+    const uint64_t end = uint64_t(pinNext) + ((uint64_t(sz)+PageSize-1) & ~uint64_t(PageSize-1));
+    if(end>0xc0000000) {
+      Log::e("failed to pin a ",size," bytes of memory: out of address space");
+      return 0;
       }
+    address = pinNext;
+    pinNext = ptr32_t(end);
+    }
+  if(uint64_t(address)+sz>0x100000000ull) {
+    Log::e("failed to pin a ",size," bytes of memory: out of address space");
+    return 0;
+    }
 
-    if(rgn.status!=S_Unused) {
+  const uint64_t end = uint64_t(address)+sz;
+  const uint32_t pg0 = address >> PageBits;
+  const uint32_t pg1 = (address+sz-1) >> PageBits;
+  for(uint32_t pg=pg0; pg<=pg1; ++pg) {
+    auto p = page(pg << PageBits);
+    if(p!=nullptr && (p->type==P_Small || p->type==P_Large)) {
       Log::e("failed to pin a ",size," bytes of memory: block is in use");
       return 0;
       }
-
-    if(address==0)
-      address = region[i].address;
-
-    if(region[i].address<address) {
-      uint32_t off = (address-region[i].address);
-      auto p2 = region[i];
-      p2.address+=off;
-      p2.size   -=off;
-      region.insert(region.begin()+ptrdiff_t(i+1),p2);
-      region[i].size = off;
-      ++i;
-      }
-    if(size!=region[i].size) {
-      auto p2 = region[i];
-      p2.address+=size;
-      p2.size   -=size;
-      region.insert(region.begin()+ptrdiff_t(i+1),p2);
+    }
+  for(auto& rgn:pinned) {
+    if(rgn.address<end && address<uint64_t(rgn.address)+std::max<uint32_t>(rgn.size,1)) {
+      Log::e("failed to pin a ",size," bytes of memory: block is in use");
+      return 0;
       }
+    }
 
-    region[i].size    = size;
-    region[i].real    = mem;
-    region[i].status  = S_Pin;
-    region[i].comment = comment;
+  for(uint32_t pg=pg0; pg<=pg1; ++pg) {
+    auto& p = mapPage(pg << PageBits);
+    if(p.type==P_Pin)
+      continue;
+    reservePage(pg);
+    p.type = P_Pin;
     }
-  return 0;
+
+  Region rgn(address,size);
+  rgn.real    = mem;
+  rgn.comment = comment;
+  pinned.push_back(rgn);
+  return address;
   }
 
 Mem32::ptr32_t Mem32::alloc(uint32_t size) {
   size = ((size+memAlign-1)/memAlign)*memAlign;
-
-  for(size_t i=0; i<region.size(); ++i) {
-    if(region[i].status!=S_Unused || region[i].size<size)
-      continue;
-    if(size!=region[i].size) {
-      auto p2 = region[i];
-      p2.address+=size;
-      p2.size   -=size;
-      region.insert(region.begin()+ptrdiff_t(i+1),p2);
-      }
-    region[i].size   = size;
-    region[i].real   = std::calloc(size,1);
-    if(region[i].real!=nullptr) {
-      region[i].status = S_Allocated;
-      return region[i].address;
-      } else {
-      compactage();
-      return 0;
-      }
+  if(size==0)
+    size = memAlign;
+  if(size<=PageSize/2) {
+    uint32_t cls = 0;
+    while((memAlign << cls)<size)
+      ++cls;
+    return allocSmall(cls);
     }
-  return 0;
+  return allocLarge(size);
   }
 
 void Mem32::free(ptr32_t address) {
   if(address==0)
     return;
-  for(size_t i=0; i<region.size(); ++i) {
-    if(region[i].address!=address)
-      continue;
-    std::free(region[i].real);
-    region[i].real   = nullptr;
-    region[i].status = S_Unused;
-    compactage();
-    return;
+  if(auto p = page(address)) {
+    if(p->type==P_Small && freeSmall(slab[p->id],address))
+      return;
+    if(p->type==P_Large && freeLarge(p->id,address))
+      return;
     }
   Log::e("mem_free: heap block wan't allocated by script: ", reinterpret_cast<void*>(uint64_t(address)));
   }
 
-void Mem32::compactage() {
-  for(size_t i=0; i+1<region.size(); ) {
-    auto& a = region[i+0];
-    auto& b = region[i+1];
-    if(a.status==S_Unused && a.status==b.status && a.address+a.size==b.address) {
-      a.size += b.size;
-      b.size = 0;
-      region.erase(region.begin()+ptrdiff_t(i+1));
-      } else {
-      ++i;
+Mem32::ptr32_t Mem32::allocSmall(uint32_t cls) {
+  const uint32_t bs   = memAlign << cls;
+  auto&          list = freeBlock[cls];
+  if(list.empty()) {
+    const uint32_t pg = allocPages(1);
+    if(pg==0)
+      return 0;
+    Slab s;
+    s.address = pg << PageBits;
+    s.cls     = uint8_t(cls);
+    s.real.reset(new uint8_t[PageSize]());
+
+    auto& p = mapPage(s.address);
+    p.type = P_Small;
+    p.id   = uint32_t(slab.size());
+    // reverse order: lower addresses are handed out first
+    for(uint32_t i=PageSize/bs; i>0; --i)
+      list.push_back(s.address + (i-1)*bs);
+    slab.push_back(std::move(s));
+    }
+
+  const ptr32_t  at  = list.back();
+  list.pop_back();
+  auto&          s   = slab[page(at)->id];
+  const uint32_t idx = (at-s.address) >> (cls+MinClassBits);
+  s.mask[idx/64] |= (uint64_t(1) << (idx%64));
+  s.used++;
+  std::memset(s.real.get()+(at-s.address),0,bs);
+  return at;
+  }
+
+Mem32::ptr32_t Mem32::allocLarge(uint32_t size) {
+  const uint32_t count = (size+PageSize-1) >> PageBits;
+  const uint32_t pg    = allocPages(count);
+  if(pg==0)
+    return 0;
+
+  void* real = std::calloc(size,1);
+  if(real==nullptr) {
+    freePages(pg,count);
+    return 0;
+    }
+
+  uint32_t id = uint32_t(large.size());
+  if(!freeLargeId.empty()) {
+    id = freeLargeId.back();
+    freeLargeId.pop_back();
+    } else {
+    large.emplace_back();
+    }
+  auto& rgn = large[id];
+  rgn       = Region(pg << PageBits,size);
+  rgn.real  = real;
+
+  for(uint32_t i=0; i<count; ++i) {
+    auto& p = mapPage((pg+i) << PageBits);
+    p.type = P_Large;
+    p.id   = id;
+    }
+  return rgn.address;
+  }
+
+bool Mem32::freeSmall(Slab& s, ptr32_t address) {
+  // empty pages are kept by size class; heap usage of scripts is bounded by peak
+  const uint32_t off = address-s.address;
+  const uint32_t idx = off >> (s.cls+MinClassBits);
+  const uint64_t bit = uint64_t(1) << (idx%64);
+  if((off & ((memAlign << s.cls)-1))!=0 || (s.mask[idx/64] & bit)==0)
+    return false;
+  s.mask[idx/64] &= ~bit;
+  s.used--;
+  freeBlock[s.cls].push_back(address);
+  return true;
+  }
+
+bool Mem32::freeLarge(uint32_t id, ptr32_t address) {
+  auto& rgn = large[id];
+  if(rgn.address!=address)
+    return false;
+
+  const uint32_t pg    = rgn.address >> PageBits;
+  const uint32_t count = (rgn.size+PageSize-1) >> PageBits;
+  for(uint32_t i=0; i<count; ++i)
+    *page((pg+i) << PageBits) = Page();
+  freePages(pg,count);
+
+  std::free(rgn.real);
+  rgn = Region();
+  freeLargeId.push_back(id);
+  return true;
+  }
+
+uint32_t Mem32::allocPages(uint32_t count) {
+  auto it = freeRunBySize.lower_bound(std::make_pair(count,uint32_t(0)));
+  if(it==freeRunBySize.end())
+    return 0;
+  const uint32_t first = it->second;
+  const uint32_t size  = it->first;
+  eraseRun(freeRun.find(first));
+  if(size>count)
+    insertRun(first+count,size-count);
+  return first;
+  }
+
+bool Mem32::reservePage(uint32_t pg) {
+  auto it = freeRun.upper_bound(pg);
+  if(it==freeRun.begin())
+    return false;
+  --it;
+  const uint32_t first = it->first;
+  const uint32_t count = it->second;
+  if(pg>=first+count)
+    return false;
+  eraseRun(it);
+  if(first<pg)
+    insertRun(first,pg-first);
+  if(pg+1<first+count)
+    insertRun(pg+1,first+count-pg-1);
+  return true;
+  }
+
+void Mem32::freePages(uint32_t first, uint32_t count) {
+  auto next = freeRun.find(first+count);
+  if(next!=freeRun.end()) {
+    count += next->second;
+    eraseRun(next);
+    }
+  auto prev = freeRun.lower_bound(first);
+  if(prev!=freeRun.begin()) {
+    --prev;
+    if(prev->first+prev->second==first) {
+      first  = prev->first;
+      count += prev->second;
+      eraseRun(prev);
       }
     }
+  insertRun(first,count);
+  }
+
+void Mem32::insertRun(uint32_t first, uint32_t count) {
+  freeRun[first] = count;
+  freeRunBySize.emplace(count,first);
+  }
+
+void Mem32::eraseRun(std::map<uint32_t,uint32_t>::iterator run) {
+  freeRunBySize.erase(std::make_pair(run->second,run->first));
+  freeRun.erase(run);
   }
 
 void Mem32::writeInt(ptr32_t address, int32_t v) {
-  auto rgn = translate(address);
-  if(rgn==nullptr || rgn->status==S_Unused) {
+  auto blk = translate(address);
+  if(blk.real==nullptr || uint64_t(address-blk.address)+4>blk.size) {
     Log::e("mem_writeint: address translation failure: ", reinterpret_cast<void*>(uint64_t(address)));
     return;
     }
-  address -= rgn->address;
-  auto ptr = reinterpret_cast<uint8_t*>(rgn->real)+address;
-  std::memcpy(ptr,&v,4);
+  std::memcpy(blk.real+(address-blk.address),&v,4);
   }
 
 int32_t Mem32::readInt(ptr32_t address) {
-  auto rgn = translate(address);
-  if(rgn==nullptr || rgn->status==S_Unused) {
+  auto blk = translate(address);
+  if(blk.real==nullptr || uint64_t(address-blk.address)+4>blk.size) {
     Log::e("mem_readint: address translation failure: ", reinterpret_cast<void*>(uint64_t(address)));
     return 0;
     }
-  address -= rgn->address;
-  auto ptr = reinterpret_cast<uint8_t*>(rgn->real)+address;
   int32_t ret = 0;
-  std::memcpy(&ret,ptr,4);
+  std::memcpy(&ret,blk.real+(address-blk.address),4);
   return ret;
   }
 
 void Mem32::copyBytes(ptr32_t psrc, ptr32_t pdst, uint32_t size) {
   auto src = translate(psrc);
   auto dst = translate(pdst);
-  if(src==nullptr || src->status==S_Unused) {
+  if(src.real==nullptr) {
     Log::e("mem_copybytes: address translation failure: ", reinterpret_cast<void*>(uint64_t(psrc)));
     return;
     }
-  if(dst==nullptr || dst->status==S_Unused) {
+  if(dst.real==nullptr) {
     Log::e("mem_copybytes: address translation failure: ", reinterpret_cast<void*>(uint64_t(pdst)));
     return;
     }
 
-  size_t sOff = psrc - src->address;
-  size_t dOff = pdst - dst->address;
+  size_t sOff = psrc - src.address;
+  size_t dOff = pdst - dst.address;
   size_t sz   = size;
-  if(src->size<sOff+size) {
+  if(src.size<sOff+size) {
     Log::e("mem_copybytes: copy-size exceed source block size: ", size);
-    sz = std::min(src->size-sOff,sz);
+    sz = std::min(src.size-sOff,sz);
     }
-  if(dst->size<dOff+size) {
+  if(dst.size<dOff+size) {
     Log::e("mem_copybytes: copy-size exceed destination block size: ", size);
-    sz = std::min(dst->size-dOff,sz);
+    sz = std::min(dst.size-dOff,sz);
     }
-  std::memcpy(reinterpret_cast<uint8_t*>(dst->real)+sOff,
-              reinterpret_cast<uint8_t*>(src->real)+dOff,
-              sz);
+  std::memmove(dst.real+dOff, src.real+sOff, sz);
   }
 
-Mem32::Region* Mem32::translate(ptr32_t address) {
-  for(auto& rgn:region) {
-    if(rgn.address<=address && address<rgn.address+rgn.size)
-      return &rgn;
+Mem32::Block Mem32::translate(ptr32_t address) const {
+  auto p = page(address);
+  if(p==nullptr)
+    return Block();
+
+  switch(p->type) {
+    case P_Unmapped:
+      break;
+    case P_Small: {
+      auto&          s   = slab[p->id];
+      const uint32_t sh  = s.cls+MinClassBits;
+      const uint32_t idx = (address-s.address) >> sh;
+      if((s.mask[idx/64] & (uint64_t(1) << (idx%64)))==0)
+        break;
+      Block b;
+      b.address = s.address + (idx << sh);
+      b.size    = 1u << sh;
+      b.real    = s.real.get() + (idx << sh);
+      return b;
+      }
+    case P_Large: {
+      auto& rgn = large[p->id];
+      if(address-rgn.address>=rgn.size)
+        break;
+      Block b;
+      b.address = rgn.address;
+      b.size    = rgn.size;
+      b.real    = reinterpret_cast<uint8_t*>(rgn.real);
+      return b;
+      }
+    case P_Pin: {
+      for(auto& rgn:pinned) {
+        if(rgn.address<=address && address-rgn.address<rgn.size) {
+          Block b;
+          b.address = rgn.address;
+          b.size    = rgn.size;
+          b.real    = reinterpret_cast<uint8_t*>(rgn.real);
+          return b;
+          }
+        }
+      break;
+      }
     }
-  return nullptr;
+  return Block();
+  }
+
+Mem32::Page* Mem32::page(ptr32_t address) const {
+  auto& t = dir[address >> (PageBits+TableBits)];
+  if(t==nullptr)
+    return nullptr;
+  return &t->page[(address >> PageBits) & (TableSize-1)];
+  }
+
+Mem32::Page& Mem32::mapPage(ptr32_t address) {
+  auto& t = dir[address >> (PageBits+TableBits)];
+  if(t==nullptr)
+    t.reset(new PageTable());
+  return t->page[(address >> PageBits) & (TableSize-1)];
   }
@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <memory>
+#include <map>
+#include <set>
+#include <cstdint>
 
 class Mem32 {
   public:
@@ -20,25 +23,83 @@ class Mem32 {
     void    copyBytes(ptr32_t src, ptr32_t dst, uint32_t size);
 
   private:
-    enum Status:uint8_t {
-      S_Unused,
-      S_Allocated,
-      S_Pin,
+    static constexpr uint32_t PageBits     = 12;
+    static constexpr uint32_t PageSize     = 1u << PageBits;
+    static constexpr uint32_t TableBits    = 10;
+    static constexpr uint32_t TableSize    = 1u << TableBits;
+    static constexpr uint32_t DirSize      = 1u << (32-PageBits-TableBits);
+    // blocks up to PageSize/2 are served from pages of a single size class: 8, 16 .. 2048 bytes
+    static constexpr uint32_t MinClassBits = 3;
+    static constexpr uint32_t NumClasses   = PageBits-MinClassBits;
+
+    enum PageType:uint8_t {
+      P_Unmapped,
+      P_Small,
+      P_Large,
+      P_Pin,
+      };
+
+    struct Page {
+      PageType type = P_Unmapped;
+      uint32_t id   = 0; // P_Small: index in 'slab'; P_Large: index in 'large'
+      };
+
+    struct PageTable {
+      Page page[TableSize];
       };
 
     struct Region {
-      Region();
+      Region() = default;
       Region(ptr32_t b, uint32_t sz):address(b),size(sz){}
       ptr32_t     address = 0;
       uint32_t    size    = 0;
       void*       real    = nullptr;
       const char* comment = nullptr;
-      Status      status  = S_Unused;
       };
 
-    Region*  translate(ptr32_t address);
-    void     compactage();
+    // page, split into blocks of one size class
+    struct Slab {
+      ptr32_t                    address = 0;
+      uint8_t                    cls     = 0;
+      uint32_t                   used    = 0;
+      uint64_t                   mask[PageSize/(64u << MinClassBits)] = {};
+      std::unique_ptr<uint8_t[]> real;
+      };
 
-    std::vector<Region> region;
-  };
+    // resolved address: block, that contains it
+    struct Block {
+      ptr32_t  address = 0;
+      uint32_t size    = 0;
+      uint8_t* real    = nullptr;
+      };
 
+    Block    translate(ptr32_t address) const;
+    Page*    page(ptr32_t address) const;
+    Page&    mapPage(ptr32_t address);
+
+    ptr32_t  allocSmall(uint32_t cls);
+    ptr32_t  allocLarge(uint32_t size);
+    bool     freeSmall(Slab& s, ptr32_t address);
+    bool     freeLarge(uint32_t id, ptr32_t address);
+
+    uint32_t allocPages(uint32_t count);
+    bool     reservePage(uint32_t pg);
+    void     freePages(uint32_t first, uint32_t count);
+    void     insertRun(uint32_t first, uint32_t count);
+    void     eraseRun(std::map<uint32_t,uint32_t>::iterator run);
+
+    std::unique_ptr<PageTable>             dir[DirSize];
+
+    std::vector<Slab>                      slab;
+    std::vector<ptr32_t>                   freeBlock[NumClasses];
+
+    std::vector<Region>                    large;
+    std::vector<uint32_t>                  freeLargeId;
+
+    std::vector<Region>                    pinned;
+    ptr32_t                                pinNext = 0;
+
+    // free page runs of user space: first page -> count, and (count,first) for best-fit
+    std::map<uint32_t,uint32_t>            freeRun;
+    std::set<std::pair<uint32_t,uint32_t>> freeRunBySize;
+  };
@@ -73,6 +73,7 @@ GameScript::GameScript(GameSession &owner)
   }
 
 GameScript::~GameScript() {
+  ScriptProfiler::onVmDestroyed();
   }
 
 
@@ -378,6 +379,8 @@ void GameScript::initCommon() {
       }
     }
 
+  initEngineSymbols();
+
   if(Ikarus::isRequired(vm)) {
     plugins.emplace_back(std::make_unique<Ikarus>(*this,vm));
     }
@@ -386,12 +389,52 @@ void GameScript::initCommon() {
     }
   }
 
+void GameScript::initEngineSymbols() {
+  engineSym.canNotUse               = findSymbol("G_CanNotUse");
+  engineSym.canNotCast              = findSymbol("G_CanNotCast");
+  engineSym.tradeNotEnoughGold      = findSymbol("player_trade_not_enough_gold");
+  engineSym.mobMissingItem          = findSymbol("player_mob_missing_item");
+  engineSym.mobMissingKey           = findSymbol("player_mob_missing_key");
+  engineSym.mobAnotherIsUsing       = findSymbol("player_mob_another_is_using");
+  engineSym.mobMissingKeyOrLockpick = findSymbol("player_mob_missing_key_or_lockpick");
+  engineSym.mobMissingLockpick      = findSymbol("player_mob_missing_lockpick");
+  engineSym.mobTooFar               = findSymbol("player_mob_too_far_away");
+  engineSym.plunderIsEmpty          = findSymbol("player_plunder_is_empty");
+  engineSym.hotkeyScreenMap         = findSymbol("player_hotkey_screen_map");
+  engineSym.spellProcessMana        = findSymbol("Spell_ProcessMana");
+  engineSym.pickLock                = findSymbol("G_PickLock");
+  engineSym.canNpcCollideWithSpell  = findSymbol("C_CanNpcCollideWithSpell");
+  engineSym.percAssessMagic         = findSymbol("PLAYER_PERC_ASSESSMAGIC");
+  engineSym.damDiveTime             = findSymbol("NPC_DAM_DIVE_TIME");
+
+  spellSym.resize(spellFxInstanceNames->count());
+  for(uint32_t i=0; i<spellSym.size(); ++i) {
+    auto& tag = spellFxInstanceNames->get_string(i);
+    char  buf[256]={};
+    std::snprintf(buf,sizeof(buf),"Spell_Cast_%s",tag.c_str());
+    spellSym[i].cast = lookupSymbol(buf);
+    std::snprintf(buf,sizeof(buf),"spellFX_%s",tag.c_str());
+    spellSym[i].vfx  = buf;
+    }
+  }
+
 void GameScript::initDialogs() {
   loadDialogOU();
 
   vm.enumerate_instances_by_class_name("C_INFO", [this](phoenix::symbol& sym){
     dialogsInfo.push_back(vm.init_instance<phoenix::c_info>(&sym));
     });
+  indexDialogs();
+  }
+
+void GameScript::indexDialogs() {
+  // C_Info.npc is expected to be final after startup/init scripts; see GameSession::initScripts
+  dialogsByNpc.clear();
+  for(auto& info:dialogsInfo) {
+    if(info->npc<0)
+      continue;
+    dialogsByNpc[size_t(info->npc)].push_back(DlgInfo{info.get(),info->symbol_index()});
+    }
   }
 
 void GameScript::loadDialogOU() {
@@ -439,7 +482,7 @@ void GameScript::initializeInstanceNpc(const std::shared_ptr<phoenix::c_npc>& np
     auto* daily_routine = vm.find_symbol_by_index(npc->daily_routine);
 
     if (daily_routine != nullptr) {
-      vm.call_function(daily_routine);
+      callFunction(daily_routine);
       }
     }
 
@@ -458,9 +501,12 @@ void GameScript::initializeInstanceItem(const std::shared_ptr<phoenix::c_item>&
 
 void GameScript::saveQuests(Serialize &fout) {
   quests.save(fout);
-  fout.write(uint32_t(dlgKnownInfos.size()));
-  for(auto& i:dlgKnownInfos)
-    fout.write(uint32_t(i.first),uint32_t(i.second));
+  // sorted: keep savegame independent of hash-set order
+  std::vector<uint64_t> known(dlgKnownInfos.begin(),dlgKnownInfos.end());
+  std::sort(known.begin(),known.end());
+  fout.write(uint32_t(known.size()));
+  for(auto i:known)
+    fout.write(uint32_t(i>>32),uint32_t(i));
 
   fout.write(gilAttitudes);
   }
@@ -469,10 +515,11 @@ void GameScript::loadQuests(Serialize& fin) {
   quests.load(fin);
   uint32_t sz=0;
   fin.read(sz);
+  dlgKnownInfos.reserve(sz);
   for(size_t i=0;i<sz;++i){
     uint32_t f=0,s=0;
     fin.read(f,s);
-    dlgKnownInfos.insert(std::make_pair(f,s));
+    dlgKnownInfos.insert(knownInfoKey(f,s));
     }
 
   fin.read(gilAttitudes);
@@ -497,7 +544,7 @@ void GameScript::loadVar(Serialize &fin) {
     switch(phoenix::datatype(t)) {
       case phoenix::datatype::integer:{
         fin.read(name);
-        auto* s = getSymbol(name);
+        auto* s = lookupSymbol(name);
 
         uint32_t size;
         fin.read(size);
@@ -514,7 +561,7 @@ void GameScript::loadVar(Serialize &fin) {
         }
       case phoenix::datatype::float_:{
         fin.read(name);
-        auto* s = getSymbol(name);
+        auto* s = lookupSymbol(name);
 
         uint32_t size;
         fin.read(size);
@@ -531,7 +578,7 @@ void GameScript::loadVar(Serialize &fin) {
         }
       case phoenix::datatype::string:{
         fin.read(name);
-        auto* s = getSymbol(name);
+        auto* s = lookupSymbol(name);
 
         uint32_t size;
         fin.read(size);
@@ -696,8 +743,7 @@ World &GameScript::world() {
   }
 
 phoenix::c_focus GameScript::getFocus(std::string_view name) {
-  // https://github.com/lmichaelis/phoenix/issues/30
-  auto id = vm.find_symbol_by_name(std::string(name));
+  auto id = findSymbol(name);
   if(id==nullptr)
     return {};
   try {
@@ -717,9 +763,7 @@ void GameScript::storeItem(Item *itm) {
   }
 
 phoenix::symbol* GameScript::getSymbol(std::string_view s) {
-  char buf[256] = {};
-  std::snprintf(buf,sizeof(buf),"%.*s",int(s.size()),s.data());
-  return vm.find_symbol_by_name(buf);
+  return findSymbol(s);
   }
 
 phoenix::symbol* GameScript::getSymbol(const size_t s) {
@@ -727,12 +771,44 @@ phoenix::symbol* GameScript::getSymbol(const size_t s) {
   }
 
 size_t GameScript::getSymbolIndex(std::string_view s) {
-  char buf[256] = {};
-  std::snprintf(buf,sizeof(buf),"%.*s",int(s.size()),s.data());
-  auto sym = vm.find_symbol_by_name(buf);
+  auto sym = findSymbol(s);
   return sym == nullptr ? size_t(-1) : sym->index();
   }
 
+phoenix::symbol* GameScript::findSymbol(std::string_view name) {
+  // symbol table is immutable after load: cache negative results as well
+  auto i = symbolCache.find(name);
+  if(i!=symbolCache.end()) {
+    symStats.cacheHits++;
+    return i->second;
+    }
+  auto sym = lookupSymbol(name);
+  symbolCache.emplace(name,sym);
+  return sym;
+  }
+
+phoenix::symbol* GameScript::lookupSymbol(std::string_view name) {
+  symStats.lookups++;
+  symStats.frame++;
+  // https://github.com/lmichaelis/phoenix/issues/30
+  return vm.find_symbol_by_name(std::string(name));
+  }
+
+void GameScript::frame() {
+  symStats.lastFrame = symStats.frame;
+  symStats.frame     = 0;
+  }
+
+void GameScript::dumpSymbolStats(const std::function<void(std::string_view)>& out) const {
+  char buf[256] = {};
+  std::snprintf(buf,sizeof(buf),"symbol lookups: last frame: %llu, total: %llu, cache hits: %llu, cached names: %d",
+                static_cast<unsigned long long>(symStats.lastFrame),
+                static_cast<unsigned long long>(symStats.lookups),
+                static_cast<unsigned long long>(symStats.cacheHits),
+                int(symbolCache.size()));
+  out(buf);
+  }
+
 size_t GameScript::getSymbolCount() const {
   return vm.symbols().size();
   }
@@ -751,11 +827,9 @@ const phoenix::c_spell& GameScript::spellDesc(int32_t splId) {
   }
 
 const VisualFx* GameScript::spellVfx(int32_t splId) {
-  auto& tag = spellFxInstanceNames->get_string(splId);
-
-  char name[256]={};
-  std::snprintf(name,sizeof(name),"spellFX_%s",tag.c_str());
-  return Gothic::inst().loadVisualFx(name);
+  if(splId<0 || size_t(splId)>=spellSym.size())
+    return nullptr;
+  return Gothic::inst().loadVisualFx(spellSym[size_t(splId)].vfx);
   }
 
 std::vector<GameScript::DlgChoise> GameScript::dialogChoises(std::shared_ptr<phoenix::c_npc> player,
@@ -764,21 +838,16 @@ std::vector<GameScript::DlgChoise> GameScript::dialogChoises(std::shared_ptr<pho
                                                                bool includeImp) {
   ScopeVar self (*vm.global_self(),  hnpc);
   ScopeVar other(*vm.global_other(), player);
-  std::vector<phoenix::c_info*> hDialog;
-  for(auto& info : dialogsInfo) {
-    if(info->npc==static_cast<int>(hnpc->symbol_index())) {
-      hDialog.push_back(info.get());
-      }
-    }
+  auto& hDialog = npcDialogs(hnpc->symbol_index());
 
   std::vector<DlgChoise> choise;
 
   for(int important=includeImp ? 1 : 0;important>=0;--important){
     for(auto& i:hDialog) {
-      const phoenix::c_info& info = *i;
+      const phoenix::c_info& info = *i.info;
       if(info.important!=important)
         continue;
-      bool npcKnowsInfo = doesNpcKnowInfo(*player,vm.find_symbol_by_instance(info)->index());
+      bool npcKnowsInfo = doesNpcKnowInfo(*player,i.sym);
       if(npcKnowsInfo && !info.permanent)
         continue;
 
@@ -797,7 +866,7 @@ std::vector<GameScript::DlgChoise> GameScript::dialogChoises(std::shared_ptr<pho
       if(info.condition) {
         auto* conditionSymbol = vm.find_symbol_by_index(info.condition);
         if (conditionSymbol != nullptr) {
-          valid = vm.call_function<int>(conditionSymbol) != 0;
+          valid = callFunction<int>(conditionSymbol) != 0;
           }
         }
       if(!valid)
@@ -806,7 +875,7 @@ std::vector<GameScript::DlgChoise> GameScript::dialogChoises(std::shared_ptr<pho
       DlgChoise ch;
       ch.title    = info.description.c_str();
       ch.scriptFn = info.information;
-      ch.handle   = i;
+      ch.handle   = i.info;
       ch.isTrade  = info.trade!=0;
       ch.sort     = info.nr;
       choise.emplace_back(std::move(ch));
@@ -863,91 +932,91 @@ void GameScript::exec(const GameScript::DlgChoise &dlg,Npc& player, Npc& npc) {
         ++i;
       }
     }
-  vm.call_function(vm.find_symbol_by_index(dlg.scriptFn));
+  callFunction(vm.find_symbol_by_index(dlg.scriptFn));
   }
 
 void GameScript::printCannotUseError(Npc& npc, int32_t atr, int32_t nValue) {
-  auto id = vm.find_symbol_by_name("G_CanNotUse");
+  auto id = engineSym.canNotUse;
   if(id==nullptr)
     return;
 
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id, npc.isPlayer(), atr, nValue);
+  callFunction<void>(id, npc.isPlayer(), atr, nValue);
   }
 
 void GameScript::printCannotCastError(Npc &npc, int32_t plM, int32_t itM) {
-  auto id = vm.find_symbol_by_name("G_CanNotCast");
+  auto id = engineSym.canNotCast;
   if(id==nullptr)
     return;
 
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id, npc.isPlayer(), itM, plM);
+  callFunction<void>(id, npc.isPlayer(), itM, plM);
   }
 
 void GameScript::printCannotBuyError(Npc &npc) {
-  auto id = vm.find_symbol_by_name("player_trade_not_enough_gold");
+  auto id = engineSym.tradeNotEnoughGold;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::printMobMissingItem(Npc &npc) {
-  auto id = vm.find_symbol_by_name("player_mob_missing_item");
+  auto id = engineSym.mobMissingItem;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::printMobMissingKey(Npc& npc) {
-  auto id = vm.find_symbol_by_name("player_mob_missing_key");
+  auto id = engineSym.mobMissingKey;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::printMobAnotherIsUsing(Npc &npc) {
-  auto id = vm.find_symbol_by_name("player_mob_another_is_using");
+  auto id = engineSym.mobAnotherIsUsing;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::printMobMissingKeyOrLockpick(Npc& npc) {
-  auto id = vm.find_symbol_by_name("player_mob_missing_key_or_lockpick");
+  auto id = engineSym.mobMissingKeyOrLockpick;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::printMobMissingLockpick(Npc& npc) {
-  auto id = vm.find_symbol_by_name("player_mob_missing_lockpick");
+  auto id = engineSym.mobMissingLockpick;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::printMobTooFar(Npc& npc) {
-  auto id = vm.find_symbol_by_name("player_mob_too_far_away");
+  auto id = engineSym.mobTooFar;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::invokeState(const std::shared_ptr<phoenix::c_npc>& hnpc, const std::shared_ptr<phoenix::c_npc>& oth, const char *name) {
-  auto id = vm.find_symbol_by_name(name);
+  auto id = findSymbol(name);
   if(id==nullptr)
     return;
 
   ScopeVar self (*vm.global_self(),  hnpc);
   ScopeVar other(*vm.global_other(), oth);
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 int GameScript::invokeState(Npc* npc, Npc* oth, Npc* vic, ScriptFn fn) {
@@ -973,9 +1042,9 @@ int GameScript::invokeState(Npc* npc, Npc* oth, Npc* vic, ScriptFn fn) {
   auto* sym = vm.find_symbol_by_index(fn.ptr);
   int ret = 0;
   if (sym!=nullptr && sym->rtype() == phoenix::datatype::integer) {
-    ret = vm.call_function<int>(sym);
+    ret = callFunction<int>(sym);
   } else if (sym!=nullptr) {
-    vm.call_function<void>(sym);
+    callFunction<void>(sym);
   }
   if(vm.global_other()->is_instance_of<phoenix::c_npc>()){
     auto oth2 = reinterpret_cast<phoenix::c_npc*>(vm.global_other()->get_instance().get());
@@ -996,26 +1065,25 @@ void GameScript::invokeItem(Npc *npc, ScriptFn fn) {
     return;
 
   ScopeVar self(*vm.global_self(), npc->handlePtr());
-  vm.call_function<void>(functionSymbol);
+  callFunction<void>(functionSymbol);
   }
 
 int GameScript::invokeMana(Npc &npc, Npc* target, Item &) {
-  auto fn = vm.find_symbol_by_name("Spell_ProcessMana");
+  auto fn = engineSym.spellProcessMana;
   if(fn==nullptr)
     return SpellCode::SPL_SENDSTOP;
 
   ScopeVar self (*vm.global_self(),  npc.handlePtr());
   ScopeVar other(*vm.global_other(), target != nullptr ? target->handlePtr() : nullptr);
 
-  return vm.call_function<int>(fn, npc.attribute(ATR_MANA));
+  return callFunction<int>(fn, npc.attribute(ATR_MANA));
   }
 
 void GameScript::invokeSpell(Npc &npc, Npc* target, Item &it) {
-  auto& tag       = spellFxInstanceNames->get_string(it.spellId());
-  char  str[256]={};
-  std::snprintf(str,sizeof(str),"Spell_Cast_%s",tag.c_str());
-
-  auto  fn  = vm.find_symbol_by_name(str);
+  const int32_t splId = it.spellId();
+  if(splId<0 || size_t(splId)>=spellSym.size())
+    return;
+  auto fn = spellSym[size_t(splId)].cast;
   if(fn==nullptr)
     return;
 
@@ -1027,52 +1095,64 @@ void GameScript::invokeSpell(Npc &npc, Npc* target, Item &it) {
   try {
     if (fn->count() == 1) {
       // this is a leveled spell
-      vm.call_function<void>(fn, splLevel);
+      callFunction<void>(fn, splLevel);
     } else {
-      vm.call_function<void>(fn);
+      callFunction<void>(fn);
     }
     }
   catch(...){
-    Log::d("unable to call spell-script: \"",str,"\'");
+    Log::d("unable to call spell-script: \"",fn->name(),"\'");
     }
   }
 
 int GameScript::invokeCond(Npc& npc, std::string_view func) {
-  // https://github.com/lmichaelis/phoenix/issues/30
-  auto fn = vm.find_symbol_by_name(std::string(func));
+  auto fn = findSymbol(func);
   if(fn==nullptr) {
     Gothic::inst().onPrint("MOBSI::conditionFunc is not invalid");
     return 1;
     }
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  return vm.call_function<int>(fn);
+  return callFunction<int>(fn);
+  }
+
+int GameScript::invokeCond(ScriptFn fn) {
+  auto sym = vm.find_symbol_by_index(fn.ptr);
+  if(sym==nullptr || sym->type()!=phoenix::datatype::function || sym->rtype()!=phoenix::datatype::integer)
+    return 0;
+  try {
+    return callFunction<int>(sym);
+    }
+  catch(const phoenix::script_error& e) {
+    Log::e("unable to call condition-script: \"",sym->name(),"\": ",e.what());
+    return 0;
+    }
   }
 
 void GameScript::invokePickLock(Npc& npc, int bSuccess, int bBrokenOpen) {
-  auto fn   = vm.find_symbol_by_name("G_PickLock");
+  auto fn   = engineSym.pickLock;
   if(fn==nullptr)
     return;
   ScopeVar self(*vm.global_self(), npc.handlePtr());
-  vm.call_function<void>(fn, bSuccess, bBrokenOpen);
+  callFunction<void>(fn, bSuccess, bBrokenOpen);
   }
 
 CollideMask GameScript::canNpcCollideWithSpell(Npc& npc, Npc* shooter, int32_t spellId) {
-  auto fn   = vm.find_symbol_by_name("C_CanNpcCollideWithSpell");
+  auto fn   = engineSym.canNpcCollideWithSpell;
   if(fn==nullptr)
     return COLL_DOEVERYTHING;
 
   ScopeVar self (*vm.global_self(),  npc.handlePtr());
   ScopeVar other(*vm.global_other(), shooter->handlePtr());
-  return CollideMask(vm.call_function<int>(fn, spellId));
+  return CollideMask(callFunction<int>(fn, spellId));
   }
 
 int GameScript::playerHotKeyScreenMap(Npc& pl) {
-  auto fn   = vm.find_symbol_by_name("player_hotkey_screen_map");
+  auto fn   = engineSym.hotkeyScreenMap;
   if(fn==nullptr)
     return -1;
 
   ScopeVar self(*vm.global_self(), pl.handlePtr());
-  int map = vm.call_function<int>(fn);
+  int map = callFunction<int>(fn);
   if(map>=0)
     pl.useItem(size_t(map));
   return map;
@@ -1157,21 +1237,21 @@ uint32_t GameScript::messageTime(std::string_view id) const {
   }
 
 void GameScript::printNothingToGet() {
-  auto id = vm.find_symbol_by_name("player_plunder_is_empty");
+  auto id = engineSym.plunderIsEmpty;
   if(id==nullptr)
     return;
   ScopeVar self(*vm.global_self(), owner.player()->handlePtr());
-  vm.call_function<void>(id);
+  callFunction<void>(id);
   }
 
 void GameScript::useInteractive(const std::shared_ptr<phoenix::c_npc>& hnpc, std::string_view func) {
-  auto fn = vm.find_symbol_by_name(std::string(func));
+  auto fn = findSymbol(func);
   if(fn == nullptr)
     return;
 
   ScopeVar self(*vm.global_self(),hnpc);
   try {
-    vm.call_function<void>(fn);
+    callFunction<void>(fn);
     }
   catch (...) {
     Log::i("unable to use interactive [",func,"]");
@@ -1246,9 +1326,7 @@ bool GameScript::searchScheme(std::string_view sc, std::string_view listName) {
   }
 
 bool GameScript::hasSymbolName(std::string_view s) {
-  char buf[256] = {};
-  std::snprintf(buf,sizeof(buf),"%.*s",int(s.size()),s.data());
-  return vm.find_symbol_by_name(buf) != nullptr;
+  return findSymbol(s) != nullptr;
   }
 
 uint64_t GameScript::tickCount() const {
@@ -1318,12 +1396,10 @@ void GameScript::removeItem(Item &it) {
   }
 
 void GameScript::setInstanceNPC(std::string_view name, Npc &npc) {
-  char buf[256] = {};
-  std::snprintf(buf,sizeof(buf),"%.*s",int(name.size()),name.data());
-  auto sym = vm.find_symbol_by_name(buf);
+  auto sym = findSymbol(name);
 
   if (sym == nullptr) {
-    Tempest::Log::e("Cannot set NPC instance ", buf, ": Symbol not found.");
+    Tempest::Log::e("Cannot set NPC instance ", name, ": Symbol not found.");
     return;
     }
 
@@ -1345,7 +1421,7 @@ AiOuputPipe *GameScript::openDlgOuput(Npc &player, Npc &npc) {
   }
 
 ScriptFn GameScript::playerPercAssessMagic() {
-  auto id = vm.find_symbol_by_name("PLAYER_PERC_ASSESSMAGIC");
+  auto id = engineSym.percAssessMagic;
   if(id==nullptr)
     return ScriptFn();
 
@@ -1355,7 +1431,7 @@ ScriptFn GameScript::playerPercAssessMagic() {
   }
 
 int GameScript::npcDamDiveTime() {
-  auto id = vm.find_symbol_by_name("NPC_DAM_DIVE_TIME");
+  auto id = engineSym.damDiveTime;
   if(id==nullptr)
     return 0;
   return id->get_int();
@@ -1799,7 +1875,7 @@ void GameScript::npc_exchangeroutine(std::shared_ptr<phoenix::c_npc> npcRef, std
     char buf[256]={};
     std::snprintf(buf,sizeof(buf),"Rtn_%.*s_%d",int(rname.length()),rname.data(),v.id);
 
-    auto* sym = vm.find_symbol_by_name(buf);
+    auto* sym = findSymbol(buf);
     size_t d = sym != nullptr ? sym->index() : 0;
     if(d>0)
       npc->excRoutine(d);
@@ -2203,17 +2279,18 @@ bool GameScript::npc_checkinfo(std::shared_ptr<phoenix::c_npc> npcRef, int imp)
   auto& pl   = *(hpl);
   auto& npc  = n->handle();
 
-  for(auto& info:dialogsInfo) {
-    if(info->npc!=int32_t(npc.symbol_index()) || info->important!=imp)
+  for(auto& i:npcDialogs(npc.symbol_index())) {
+    auto info = i.info;
+    if(info->important!=imp)
       continue;
-    bool npcKnowsInfo = doesNpcKnowInfo(pl,info->symbol_index());
+    bool npcKnowsInfo = doesNpcKnowInfo(pl,i.sym);
     if(npcKnowsInfo && !info->permanent)
       continue;
     bool valid=false;
     if(info->condition) {
       auto* conditionSymbol = vm.find_symbol_by_index(info->condition);
       if (conditionSymbol != nullptr)
-        valid = vm.call_function<int>(conditionSymbol)!=0;
+        valid = callFunction<int>(conditionSymbol)!=0;
       }
     if(valid) {
       return true;
@@ -3030,12 +3107,23 @@ void GameScript::sort(std::vector<GameScript::DlgChoise> &dlg) {
     });
   }
 
+auto GameScript::npcDialogs(size_t npcInstance) const -> const std::vector<DlgInfo>& {
+  static const std::vector<DlgInfo> empty;
+  auto i = dialogsByNpc.find(npcInstance);
+  if(i==dialogsByNpc.end())
+    return empty;
+  return i->second;
+  }
+
 void GameScript::setNpcInfoKnown(const phoenix::c_npc& npc, const phoenix::c_info &info) {
-  auto id = std::make_pair(vm.find_symbol_by_instance(npc)->index(),vm.find_symbol_by_instance(info)->index());
-  dlgKnownInfos.insert(id);
+  dlgKnownInfos.insert(knownInfoKey(npc.symbol_index(),info.symbol_index()));
   }
 
 bool GameScript::doesNpcKnowInfo(const phoenix::c_npc& npc, size_t infoInstance) const {
-  auto id = std::make_pair(vm.find_symbol_by_instance(npc)->index(),infoInstance);
-  return dlgKnownInfos.find(id)!=dlgKnownInfos.end();
+  return dlgKnownInfos.find(knownInfoKey(npc.symbol_index(),infoInstance))!=dlgKnownInfos.end();
+  }
+
+uint64_t GameScript::knownInfoKey(size_t npcInstance, size_t infoInstance) {
+  // symbol indices are 32-bit in savegame
+  return (uint64_t(npcInstance)<<32) | uint64_t(uint32_t(infoInstance));
   }
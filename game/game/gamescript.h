@@ -4,8 +4,10 @@
 #include <phoenix/ext/daedalus_classes.hh>
 #include <phoenix/messages.hh>
 
+#include <functional>
 #include <memory>
-#include <set>
+#include <unordered_set>
+#include <unordered_map>
 #include <random>
 
 #include <Tempest/Matrix4x4>
@@ -18,6 +20,7 @@
 #include "game/constants.h"
 #include "game/aistate.h"
 #include "game/questlog.h"
+#include "game/scriptprofiler.h"
 #include "graphics/pfx/pfxobjects.h"
 #include "ui/documentmenu.h"
 
@@ -59,8 +62,11 @@ class GameScript final {
       };
 
     bool         hasSymbolName(std::string_view fn);
+    void         frame();
+    void         dumpSymbolStats(const std::function<void(std::string_view)>& out) const;
 
     void         initDialogs ();
+    void         indexDialogs();
     void         loadDialogOU();
 
     void initializeInstanceNpc(const std::shared_ptr<phoenix::c_npc>& npc, size_t instance);
@@ -130,6 +136,7 @@ class GameScript final {
     int  invokeMana (Npc& npc, Npc* target, Item&  fn);
     void invokeSpell(Npc& npc, Npc *target, Item&  fn);
     int  invokeCond (Npc& npc, std::string_view func);
+    int  invokeCond (ScriptFn fn);
     void invokePickLock(Npc& npc, int bSuccess, int bBrokenOpen);
     auto canNpcCollideWithSpell(Npc& npc, Npc* shooter, int32_t spellId) -> CollideMask;
 
@@ -169,8 +176,18 @@ class GameScript final {
 
     template <class F>
     void bindExternal(const std::string& name, F function) {
+      auto* sym = vm.find_symbol_by_name(name);
       vm.register_external(name, std::function<typename DetermineSignature<F>::signature> (
-        [this, function](auto ... v) { return (this->*function)(v...); }));
+        [this, function, sym](auto ... v) {
+          ScriptProfiler::Scope prof(sym,true);
+          return (this->*function)(v...);
+          }));
+      }
+
+    template <typename R = void, typename ... P>
+    R callFunction(phoenix::symbol* sym, P ... args) {
+      ScriptProfiler::Scope prof(sym,false);
+      return vm.call_function<R>(sym, args...);
       }
 
     void               initCommon();
@@ -403,12 +420,23 @@ class GameScript final {
 
     void exitsession         ();
 
+    struct DlgInfo final {
+      phoenix::c_info* info = nullptr;
+      size_t           sym  = 0;
+      };
+
     void sort(std::vector<DlgChoise>& dlg);
+    auto npcDialogs(size_t npcInstance) const -> const std::vector<DlgInfo>&;
     void setNpcInfoKnown(const phoenix::c_npc& npc, const phoenix::c_info& info);
     bool doesNpcKnowInfo(const phoenix::c_npc& npc, size_t infoInstance) const;
+    static uint64_t knownInfoKey(size_t npcInstance, size_t infoInstance);
 
     void saveSym(Serialize& fout, phoenix::symbol& s);
 
+    phoenix::symbol* findSymbol  (std::string_view name);
+    phoenix::symbol* lookupSymbol(std::string_view name);
+    void             initEngineSymbols();
+
     void onWldInstanceRemoved(const phoenix::instance* obj);
     void makeCurrent(Item* w);
 
@@ -422,8 +450,9 @@ class GameScript final {
     std::unique_ptr<SvmDefinitions>                             svm;
     uint64_t                                                    svmBarrier=0;
 
-    std::set<std::pair<size_t,size_t>>                          dlgKnownInfos;
+    std::unordered_set<uint64_t>                                dlgKnownInfos; // see knownInfoKey
     std::vector<std::shared_ptr<phoenix::c_info>>     dialogsInfo;
+    std::unordered_map<size_t,std::vector<DlgInfo>>             dialogsByNpc;  // npc instance -> infos, in script order
     phoenix::messages                                           dialogs;
     std::unordered_map<size_t,AiState>                          aiStates;
     std::unique_ptr<AiOuputPipe>                                aiDefaultPipe;
@@ -448,4 +477,43 @@ class GameScript final {
 
     phoenix::c_focus                                            cFocusNorm,cFocusMele,cFocusRange,cFocusMage;
     std::shared_ptr<phoenix::c_gil_values>            cGuildVal;
+
+    // script functions and constants, used by engine; resolved once, after script load
+    struct EngineSymbols final {
+      phoenix::symbol* canNotUse               = nullptr;
+      phoenix::symbol* canNotCast              = nullptr;
+      phoenix::symbol* tradeNotEnoughGold      = nullptr;
+      phoenix::symbol* mobMissingItem          = nullptr;
+      phoenix::symbol* mobMissingKey           = nullptr;
+      phoenix::symbol* mobAnotherIsUsing       = nullptr;
+      phoenix::symbol* mobMissingKeyOrLockpick = nullptr;
+      phoenix::symbol* mobMissingLockpick      = nullptr;
+      phoenix::symbol* mobTooFar               = nullptr;
+      phoenix::symbol* plunderIsEmpty          = nullptr;
+      phoenix::symbol* hotkeyScreenMap         = nullptr;
+      phoenix::symbol* spellProcessMana        = nullptr;
+      phoenix::symbol* pickLock                = nullptr;
+      phoenix::symbol* canNpcCollideWithSpell  = nullptr;
+      phoenix::symbol* percAssessMagic         = nullptr;
+      phoenix::symbol* damDiveTime             = nullptr;
+      };
+    struct SpellSymbols final {
+      phoenix::symbol* cast = nullptr; // Spell_Cast_<tag>
+      std::string      vfx;            // spellFX_<tag>
+      };
+    struct StringHash final {
+      using is_transparent = void;
+      size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+      };
+    struct SymbolStats final {
+      uint64_t lookups   = 0; // vm.find_symbol_by_name calls
+      uint64_t cacheHits = 0;
+      uint64_t frame     = 0; // lookups in current frame
+      uint64_t lastFrame = 0;
+      };
+
+    EngineSymbols                                               engineSym;
+    std::vector<SpellSymbols>                                   spellSym;
+    std::unordered_map<std::string,phoenix::symbol*,StringHash,std::equal_to<>> symbolCache;
+    SymbolStats                                                 symStats;
   };
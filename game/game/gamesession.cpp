@@ -13,6 +13,7 @@
 #include "sound/soundfx.h"
 #include "serialize.h"
 #include "camera.h"
+#include "utils/profiler.h"
 #include "gothic.h"
 
 using namespace Tempest;
@@ -97,6 +98,7 @@ GameSession::GameSession(std::string file) {
   }
 
 GameSession::GameSession(Serialize &fin) {
+  Profiler::Zone zone("GameSession::load");
   Gothic::inst().setLoadingProgress(0);
 
   SaveGameHeader hdr;
@@ -153,6 +155,7 @@ GameSession::~GameSession() {
   }
 
 void GameSession::save(Serialize &fout, std::string_view name, const Pixmap& screen) {
+  Profiler::Zone zone("GameSession::save");
   SaveGameHeader hdr;
   hdr.version   = Serialize::Version::Current;
   hdr.name      = name;
@@ -280,6 +283,7 @@ void GameSession::tick(uint64_t dt) {
   wrldTime.addMilis(add/divTime);
 
   wrld->tick(dt);
+  vm->frame();
   // std::this_thread::sleep_for(std::chrono::milliseconds(60));
 
   if(exitSessionFlg) {
@@ -453,5 +457,7 @@ void GameSession::initScripts(bool firstTime) {
   if(vm->hasSymbolName(init))
     vm->getVm().call_function(init);
 
+  // startup scripts may assign C_Info.npc
+  vm->indexDialogs();
   wrld->resetPositionToTA();
   }
@@ -0,0 +1,131 @@
+#include "scriptprofiler.h"
+
+#include <phoenix/script.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// scripts are executed on main thread only: no locking
+struct ScriptProfEntry final {
+  std::string name;
+  bool        external  = false;
+  uint64_t    calls     = 0;
+  uint64_t    inclusive = 0; // ns; recursive calls are counted once
+  uint64_t    exclusive = 0; // ns; without nested externals and engine->script calls
+  uint32_t    depth     = 0;
+  };
+
+struct ScriptProfFrame final {
+  size_t   entry = 0;
+  uint64_t start = 0;
+  uint64_t child = 0;
+  };
+
+static std::vector<ScriptProfEntry>                       entries;
+static std::unordered_map<std::string,size_t>             byName;
+static std::unordered_map<const phoenix::symbol*,size_t>  bySymbol;
+static std::vector<ScriptProfFrame>                       stack;
+
+static uint64_t timeNs() {
+  using namespace std::chrono;
+  return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+
+static size_t entryOf(const phoenix::symbol& sym, bool external) {
+  auto i = bySymbol.find(&sym);
+  if(i!=bySymbol.end())
+    return i->second;
+
+  std::string key = sym.name();
+  if(external)
+    key.insert(0,"ext:");
+  auto n = byName.find(key);
+  size_t id = 0;
+  if(n!=byName.end()) {
+    id = n->second;
+    } else {
+    id = entries.size();
+    ScriptProfEntry e;
+    e.name     = sym.name();
+    e.external = external;
+    entries.push_back(std::move(e));
+    byName.emplace(std::move(key),id);
+    }
+  bySymbol.emplace(&sym,id);
+  return id;
+  }
+
+std::atomic_bool ScriptProfiler::enabled{false};
+
+void ScriptProfiler::setEnabled(bool e) {
+  enabled.store(e);
+  }
+
+void ScriptProfiler::reset() {
+  entries.clear();
+  byName.clear();
+  bySymbol.clear();
+  stack.clear();
+  }
+
+void ScriptProfiler::onVmDestroyed() {
+  bySymbol.clear();
+  stack.clear();
+  }
+
+bool ScriptProfiler::begin(const phoenix::symbol& sym, bool external) {
+  ScriptProfFrame f;
+  f.entry = entryOf(sym,external);
+  entries[f.entry].depth++;
+  f.start = timeNs();
+  stack.push_back(f);
+  return true;
+  }
+
+void ScriptProfiler::end() {
+  if(stack.empty())
+    return; // reset, while call is in progress
+  const uint64_t        now = timeNs();
+  const ScriptProfFrame f   = stack.back();
+  stack.pop_back();
+
+  const uint64_t dt = now-f.start;
+  auto&          e  = entries[f.entry];
+  e.calls++;
+  e.depth--;
+  e.exclusive += dt-std::min(dt,f.child);
+  if(e.depth==0)
+    e.inclusive += dt;
+  if(!stack.empty())
+    stack.back().child += dt;
+  }
+
+void ScriptProfiler::dump(const std::function<void(std::string_view)>& out, size_t maxLines) {
+  std::vector<const ScriptProfEntry*> fn, ext;
+  for(auto& e:entries)
+    (e.external ? ext : fn).push_back(&e);
+  auto cmp = [](const ScriptProfEntry* a, const ScriptProfEntry* b){
+    return a->exclusive>b->exclusive;
+    };
+  std::sort(fn.begin(), fn.end(), cmp);
+  std::sort(ext.begin(),ext.end(),cmp);
+
+  char buf[256] = {};
+  auto print = [&](std::string_view title, const std::vector<const ScriptProfEntry*>& list) {
+    std::snprintf(buf,sizeof(buf),"%.*s: %d",int(title.size()),title.data(),int(list.size()));
+    out(buf);
+    for(size_t i=0; i<list.size() && i<maxLines; ++i) {
+      auto& e = *list[i];
+      std::snprintf(buf,sizeof(buf),"  %-40s calls: %8llu, incl: %10.3f ms, excl: %10.3f ms",
+                    e.name.c_str(), static_cast<unsigned long long>(e.calls),
+                    double(e.inclusive)/1000000.0, double(e.exclusive)/1000000.0);
+      out(buf);
+      }
+    };
+  print("script functions",fn);
+  print("externals",ext);
+  }
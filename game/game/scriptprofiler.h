@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace phoenix {
+class symbol;
+}
+
+// opt-in profiler of Daedalus calls: engine->script calls and externals, made through GameScript
+class ScriptProfiler final {
+  public:
+    // scoped call of script function or external; sym may be null
+    class Scope final {
+      public:
+        Scope(const phoenix::symbol* sym, bool external) {
+          if(isEnabled() && sym!=nullptr)
+            active = begin(*sym,external);
+          }
+        ~Scope() {
+          if(active)
+            end();
+          }
+        Scope(const Scope&) = delete;
+        Scope& operator = (const Scope&) = delete;
+
+      private:
+        bool active = false;
+      };
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool e);
+    static void reset();
+
+    // symbols of destroyed vm must not be used as keys anymore; collected data is kept
+    static void onVmDestroyed();
+
+    // table of functions, sorted by exclusive time
+    static void dump(const std::function<void(std::string_view)>& out, size_t maxLines = size_t(-1));
+
+  private:
+    static bool             begin(const phoenix::symbol& sym, bool external);
+    static void             end();
+
+    static std::atomic_bool enabled;
+  };
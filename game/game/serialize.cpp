@@ -7,6 +7,7 @@
 #include "world/world.h"
 #include "world/fplock.h"
 #include "world/waypoint.h"
+#include "utils/profiler.h"
 
 #include <Tempest/MemReader>
 #include <Tempest/MemWriter>
@@ -79,6 +80,7 @@ std::string_view Serialize::worldName() const {
   }
 
 void Serialize::closeEntry() {
+  Profiler::Zone zone("Serialize::writeEntry");
   if(fout==nullptr)
     return;
   if(entryBuf.empty())
@@ -93,6 +95,7 @@ void Serialize::closeEntry() {
   }
 
 bool Serialize::implSetEntry(std::string fname) {
+  Profiler::Zone zone("Serialize::setEntry");
   closeEntry();
   entryName = std::move(fname);
   if(fout!=nullptr) {
@@ -34,7 +34,7 @@ class SaveGameHeader;
 class Serialize {
   public:
     enum Version : uint16_t {
-      Current = 40
+      Current = 41
       };
     Serialize(Tempest::ODevice& fout);
     Serialize(Tempest::IDevice&  fin);
@@ -60,6 +60,9 @@ Gothic::Gothic() {
   defaults->set("GAME", "animatedWindows",     1);
   defaults->set("GAME", "useGothic1Controls",  0);
   defaults->set("GAME", "highlightMeleeFocus", 0);
+  defaults->set("GAME", "losCacheTime",        250);
+  defaults->set("GAME", "simFarInterval",      50);
+  defaults->set("GAME", "simFar2Ticks",        64);
 
   defaults->set("SKY_OUTDOOR", "zSunName",   "unsun5.tga");
   defaults->set("SKY_OUTDOOR", "zSunSize",   200);
@@ -364,6 +367,10 @@ bool Gothic::doMeshShading() const {
   return isMeshSh;
   }
 
+bool Gothic::isHeadless() const {
+  return CommandLine::inst().isHeadless();
+  }
+
 Gothic::LoadState Gothic::checkLoading() const {
   return loadingFlag.load();
   }
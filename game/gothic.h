@@ -91,6 +91,7 @@ class Gothic final {
 
     bool         doRayQuery() const;
     bool         doMeshShading() const;
+    bool         isHeadless() const;
 
     bool         doRespawn() const { return respawn; };
 
@@ -107,23 +107,32 @@ LightGroup::Light::Light(LightGroup& owner, const phoenix::vobs::light& vob)
   data = std::move(l);
 }
 
-LightGroup::Light::Light(World& owner, std::string_view preset)
-  :Light(owner,owner.view()->sGlobal.lights.findPreset(preset)){
+LightGroup::Light::Light(World& owner, std::string_view preset) {
+  if(owner.view()==nullptr)
+    return; // headless
+  auto& lights = owner.view()->sGlobal.lights;
+  *this = Light(lights,lights.findPreset(preset));
   setTimeOffset(owner.tickCount());
   }
 
-LightGroup::Light::Light(World& owner, const phoenix::vobs::light_preset& vob)
-  :Light(owner.view()->sGlobal.lights,vob) {
+LightGroup::Light::Light(World& owner, const phoenix::vobs::light_preset& vob) {
+  if(owner.view()==nullptr)
+    return;
+  *this = Light(owner.view()->sGlobal.lights,vob);
   setTimeOffset(owner.tickCount());
   }
 
-LightGroup::Light::Light(World& owner, const phoenix::vobs::light& vob)
-  :Light(owner.view()->sGlobal.lights,vob){
+LightGroup::Light::Light(World& owner, const phoenix::vobs::light& vob) {
+  if(owner.view()==nullptr)
+    return;
+  *this = Light(owner.view()->sGlobal.lights,vob);
   setTimeOffset(owner.tickCount());
-}
+  }
 
-LightGroup::Light::Light(World& owner)
-  :Light(owner.view()->sGlobal.lights) {
+LightGroup::Light::Light(World& owner) {
+  if(owner.view()==nullptr)
+    return;
+  *this = Light(owner.view()->sGlobal.lights);
   setTimeOffset(owner.tickCount());
   }
 
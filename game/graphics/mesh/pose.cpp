@@ -6,6 +6,7 @@
 #include "world/world.h"
 #include "game/serialize.h"
 #include "utils/fileext.h"
+#include "utils/profiler.h"
 #include "skeleton.h"
 #include "animmath.h"
 
@@ -295,6 +296,7 @@ void Pose::processLayers(AnimationSolver& solver, uint64_t tickCount) {
   }
 
 bool Pose::update(uint64_t tickCount) {
+  Profiler::Zone zone("Pose::update");
   if(lay.size()==0) {
     const bool ret = needToUpdate;
     if(needToUpdate || lastUpdate==0)
@@ -10,6 +10,7 @@
 #include "graphics/sceneglobals.h"
 #include "graphics/lightsource.h"
 #include "world/world.h"
+#include "utils/profiler.h"
 
 #include "pfxbucket.h"
 #include "particlefx.h"
@@ -32,6 +33,7 @@ void PfxObjects::resetTicks() {
   }
 
 void PfxObjects::tick(uint64_t ticks) {
+  Profiler::Zone zone("PfxObjects::tick");
   static bool disabled = false;
   if(disabled)
     return;
@@ -154,8 +154,10 @@ struct TrlObjects::Bucket {
   };
 
 
-TrlObjects::Item::Item(World& world, const ParticleFx& ow)
-  :Item(world.view()->pfxGroup.trails, ow) {
+TrlObjects::Item::Item(World& world, const ParticleFx& ow) {
+  if(world.view()==nullptr)
+    return; // headless
+  *this = Item(world.view()->pfxGroup.trails, ow);
   }
 
 TrlObjects::Item::Item(TrlObjects& trl, const ParticleFx& ow) {
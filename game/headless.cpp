@@ -0,0 +1,146 @@
+#include "headless.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "game/gamescript.h"
+#include "game/gamesession.h"
+#include "game/scriptprofiler.h"
+#include "game/serialize.h"
+#include "utils/profiler.h"
+#include "commandline.h"
+#include "gothic.h"
+
+using namespace Tempest;
+
+static uint64_t timeUs() {
+  using namespace std::chrono;
+  return uint64_t(duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count());
+  }
+
+Headless::Headless() {
+  auto& cmd = CommandLine::inst();
+  dt       = cmd.headlessDt();
+  maxTicks = cmd.headlessTicks();
+  until    = cmd.headlessUntil();
+  }
+
+Headless::~Headless() {
+  Gothic::inst().setGame(std::unique_ptr<GameSession>());
+  }
+
+int Headless::exec() {
+  const uint64_t loadStart = timeUs();
+  try {
+    Gothic::inst().setGame(load());
+    }
+  catch(const std::exception& e) {
+    Log::e("headless: unable to load game: ",e.what());
+    return 1;
+    }
+  const uint64_t loadTime = timeUs()-loadStart;
+  if(Gothic::inst().world()==nullptr) {
+    Log::e("headless: no world loaded");
+    return 1;
+    }
+  if(!resolveStopCondition())
+    return 1;
+
+  tickTime.reserve(maxTicks);
+  const uint64_t wallStart = timeUs();
+  for(uint32_t i=0; i<maxTicks; ++i) {
+    Profiler::frame();
+    const uint64_t t0 = timeUs();
+    {
+      Profiler::Zone zone("Headless::tick");
+      Gothic::inst().tick(dt);
+      Gothic::inst().updateAnimation(dt);
+    }
+    tickTime.push_back(timeUs()-t0);
+
+    if(Gothic::inst().world()==nullptr)
+      break; // session exit or world change, triggered by script
+    if(isStopCondition())
+      break;
+    }
+  printStats(loadTime,timeUs()-wallStart);
+  if(ScriptProfiler::isEnabled())
+    printScriptProfile();
+  return 0;
+  }
+
+std::unique_ptr<GameSession> Headless::load() {
+  auto& gothic = Gothic::inst();
+  if(!gothic.defaultSave().empty()) {
+    RFile     file{std::string(gothic.defaultSave())};
+    Serialize s(file);
+    return std::unique_ptr<GameSession>(new GameSession(s));
+    }
+  return std::unique_ptr<GameSession>(new GameSession(std::string(gothic.defaultWorld())));
+  }
+
+bool Headless::resolveStopCondition() {
+  if(until.empty())
+    return true;
+  auto& script = Gothic::inst().world()->script();
+  auto* sym    = script.getSymbol(until);
+  if(sym==nullptr || sym->type()!=phoenix::datatype::function) {
+    Log::e("headless: script function not found: \"",until,"\"");
+    return false;
+    }
+  if(sym->rtype()!=phoenix::datatype::integer) {
+    Log::e("headless: script function must return int: \"",until,"\"");
+    return false;
+    }
+  untilFn = sym->index();
+  return true;
+  }
+
+bool Headless::isStopCondition() {
+  if(untilFn==size_t(-1))
+    return false;
+  return Gothic::inst().world()->script().invokeCond(untilFn)!=0;
+  }
+
+void Headless::printStats(uint64_t loadTime, uint64_t wallTime) const {
+  if(tickTime.empty())
+    return;
+
+  auto sorted = tickTime;
+  std::sort(sorted.begin(),sorted.end());
+
+  uint64_t sum = 0;
+  for(auto t:sorted)
+    sum += t;
+
+  const size_t   cnt  = sorted.size();
+  const double   avg  = double(sum)/double(cnt);
+  const uint64_t p50  = sorted[cnt/2];
+  const uint64_t p99  = sorted[std::min(cnt-1,(cnt*99)/100)];
+  const double   wall = double(std::max<uint64_t>(wallTime,1))/1000000.0;
+  const double   sim  = double(cnt*dt)/1000.0;
+
+  char buf[512] = {};
+  std::snprintf(buf,sizeof(buf),
+                "headless: %u ticks of %u ms; load %.2f s\n"
+                "  tick  avg: %.3f ms, min: %.3f ms, p50: %.3f ms, p99: %.3f ms, max: %.3f ms\n"
+                "  wall: %.2f s, simulated: %.2f s, %.1f ticks/s, x%.1f realtime",
+                unsigned(cnt), unsigned(dt), double(loadTime)/1000000.0,
+                avg/1000.0, double(sorted.front())/1000.0, double(p50)/1000.0, double(p99)/1000.0, double(sorted.back())/1000.0,
+                wall, sim, double(cnt)/wall, sim/wall);
+  std::printf("%s\n",buf);
+  std::fflush(stdout);
+  Log::i(buf);
+  }
+
+void Headless::printScriptProfile() const {
+  ScriptProfiler::dump([](std::string_view s){
+    std::printf("%.*s\n",int(s.size()),s.data());
+    Log::i(std::string(s));
+    });
+  std::fflush(stdout);
+  }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GameSession;
+
+// runs simulation at fixed time step, without window and renderer
+class Headless final {
+  public:
+    Headless();
+    ~Headless();
+
+    int  exec();
+
+  private:
+    std::unique_ptr<GameSession> load();
+    bool resolveStopCondition();
+    bool isStopCondition();
+    void printStats(uint64_t loadTime, uint64_t wallTime) const;
+    void printScriptProfile() const;
+
+    uint32_t              dt       = 0;
+    uint32_t              maxTicks = 0;
+    std::string           until;
+    size_t                untilFn  = size_t(-1); // symbol of 'until', resolved after load
+    std::vector<uint64_t> tickTime; // in microseconds
+  };
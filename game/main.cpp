@@ -16,9 +16,12 @@
 
 #include "utils/crashlog.h"
 #include "mainwindow.h"
+#include "headless.h"
 #include "gothic.h"
 #include "build.h"
 #include "commandline.h"
+#include "utils/profiler.h"
+#include "game/scriptprofiler.h"
 
 const char* selectDevice(const Tempest::AbstractGraphicsApi& api) {
   auto d = api.devices();
@@ -95,6 +98,10 @@ int main(int argc,const char** argv) {
   Tempest::Log::i(appBuild);
 
   CommandLine          cmd{argc,argv};
+  Profiler::setThreadName("Main");
+  Profiler::setEnabled(!cmd.profileFile().empty());
+  ScriptProfiler::setEnabled(cmd.isScriptProfile());
+
   auto                 api = mkApi(cmd);
 
   Tempest::Device      device{*api,selectDevice(*api)};
@@ -104,7 +111,17 @@ int main(int argc,const char** argv) {
   GameMusic            music;
   gothic.setupGlobalScripts();
 
-  MainWindow           wx(device);
-  Tempest::Application app;
-  return app.exec();
+  int                  ret = 0;
+  if(cmd.isHeadless()) {
+    Headless hl;
+    ret = hl.exec();
+    } else {
+    MainWindow           wx(device);
+    Tempest::Application app;
+    ret = app.exec();
+    }
+
+  if(!cmd.profileFile().empty())
+    Profiler::dump(cmd.profileFile());
+  return ret;
   }
@@ -22,6 +22,7 @@
 #include "utils/crashlog.h"
 #include "utils/gthfont.h"
 #include "utils/dbgpainter.h"
+#include "utils/profiler.h"
 
 #include "commandline.h"
 #include "gothic.h"
@@ -972,6 +973,8 @@ void MainWindow::setFullscreen(bool fs) {
   }
 
 void MainWindow::render(){
+  Profiler::frame();
+  Profiler::Zone zone("MainWindow::render");
   try {
     static uint64_t time=Application::tickCount();
 
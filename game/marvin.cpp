@@ -6,7 +6,10 @@
 
 #include "world/objects/npc.h"
 #include "world/respawnobject.h"
+#include "game/scriptprofiler.h"
+#include "utils/profiler.h"
 #include "camera.h"
+#include "commandline.h"
 #include "gothic.h"
 
 static bool startsWith(std::string_view str, std::string_view needle) {
@@ -121,6 +124,14 @@ Marvin::Marvin() {
 
     // Respawn system [clear,show,process]
     {"respawn %s",        C_Respawn},
+
+    {"waynet stats",      C_WaynetStats},
+    {"los stats",         C_LosStats},
+    {"trigger stats",     C_TriggerStats},
+    {"simlod stats",      C_SimLodStats},
+    {"symbol stats",      C_SymbolStats},
+    {"profile %s",        C_Profile},
+    {"script profile %s", C_ScriptProfile},
     };
   }
 
@@ -271,6 +282,45 @@ bool Marvin::exec(std::string_view v) {
     case C_Respawn: {
       return RespawnObject::handleCommand(ret.argv[0]);
       }
+    case C_WaynetStats: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      world->dumpWaynetStats([this](std::string_view s){ print(s); });
+      return true;
+      }
+    case C_LosStats: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      world->dumpLosStats([this](std::string_view s){ print(s); });
+      return true;
+      }
+    case C_TriggerStats: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      world->dumpTriggerStats([this](std::string_view s){ print(s); });
+      return true;
+      }
+    case C_SimLodStats: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      world->dumpSimLodStats([this](std::string_view s){ print(s); });
+      return true;
+      }
+    case C_SymbolStats: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      world->script().dumpSymbolStats([this](std::string_view s){ print(s); });
+      return true;
+      }
+    case C_Profile:
+      return execProfile(ret.argv[0]);
+    case C_ScriptProfile:
+      return execScriptProfile(ret.argv[0]);
     }
 
   return true;
@@ -331,6 +381,52 @@ bool Marvin::printVariable(World* world, std::string_view name) {
   return true;
   }
 
+bool Marvin::execProfile(std::string_view cmd) {
+  if(cmd=="start") {
+    Profiler::setEnabled(true);
+    print("profiler: enabled");
+    return true;
+    }
+  if(cmd=="stop") {
+    Profiler::setEnabled(false);
+    print("profiler: disabled");
+    return true;
+    }
+  if(cmd=="dump") {
+    auto file = CommandLine::inst().profileFile();
+    if(file.empty())
+      file = "profile.json";
+    if(!Profiler::dump(file))
+      return false;
+    print(std::string("profiler: trace written to ").append(file));
+    return true;
+    }
+  return false;
+  }
+
+bool Marvin::execScriptProfile(std::string_view cmd) {
+  if(cmd=="start") {
+    ScriptProfiler::setEnabled(true);
+    print("script profiler: enabled");
+    return true;
+    }
+  if(cmd=="stop") {
+    ScriptProfiler::setEnabled(false);
+    print("script profiler: disabled");
+    return true;
+    }
+  if(cmd=="reset") {
+    ScriptProfiler::reset();
+    print("script profiler: reset");
+    return true;
+    }
+  if(cmd=="dump") {
+    ScriptProfiler::dump([this](std::string_view s){ print(s); }, 16);
+    return true;
+    }
+  return false;
+  }
+
 std::string_view Marvin::completeInstanceName(std::string_view inp, bool& fullword) const {
   World* world  = Gothic::inst().world();
   if(world==nullptr || inp.size()==0)
@@ -34,7 +34,16 @@ class Marvin {
       C_ToogleCamera,
 
       C_Insert,
-      C_Respawn
+      C_Respawn,
+
+      // debug
+      C_WaynetStats,
+      C_LosStats,
+      C_TriggerStats,
+      C_SimLodStats,
+      C_SymbolStats,
+      C_Profile,
+      C_ScriptProfile
       };
 
     struct Cmd {
@@ -60,6 +69,8 @@ class Marvin {
 
     bool   addItemOrNpcBySymbolName(World* world, std::string_view name, const Tempest::Vec3& at);
     bool   printVariable           (World* world, std::string_view name);
+    bool   execProfile             (std::string_view cmd);
+    bool   execScriptProfile       (std::string_view cmd);
 
     std::vector<Cmd> cmd;
   };
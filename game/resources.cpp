@@ -28,6 +28,7 @@
 #include "graphics/mesh/protomesh.h"
 #include "graphics/mesh/animation.h"
 #include "graphics/mesh/attachbinder.h"
+#include "utils/profiler.h"
 #include "graphics/material.h"
 #include "physics/physicmeshshape.h"
 #include "dmusic/music.h"
@@ -260,6 +261,7 @@ int64_t Resources::vdfTimestamp(const std::u16string& name) {
   }
 
 Tempest::Texture2d* Resources::implLoadTexture(TextureCache& cache, std::string_view cname) {
+  Profiler::Zone zone("Resources::loadTexture");
   if(cname.empty())
     return nullptr;
 
@@ -350,6 +352,7 @@ ProtoMesh* Resources::implLoadMesh(std::string_view name) {
   }
 
 std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
+  Profiler::Zone zone("Resources::loadMesh");
   if(FileExt::hasExt(name,"3DS")) {
     FileExt::exchangeExt(name,"3DS","MRM");
 
@@ -458,6 +461,7 @@ std::unique_ptr<ProtoMesh> Resources::implLoadMeshMain(std::string name) {
   }
 
 PfxEmitterMesh* Resources::implLoadEmiterMesh(std::string_view name) {
+  Profiler::Zone zone("Resources::loadEmiterMesh");
   // TODO: reuse code from Resources::implLoadMeshMain
   auto cname = std::string(name);
   auto it    = emiMeshCache.find(cname);
@@ -548,6 +552,7 @@ ProtoMesh* Resources::implDecalMesh(const phoenix::vob& vob) {
   }
 
 std::unique_ptr<Animation> Resources::implLoadAnimation(std::string name) {
+  Profiler::Zone zone("Resources::loadAnimation");
   if(name.size()<4)
     return nullptr;
 
@@ -572,11 +577,13 @@ std::unique_ptr<Animation> Resources::implLoadAnimation(std::string name) {
   }
 
 Dx8::PatternList Resources::implLoadDxMusic(std::string_view name) {
+  Profiler::Zone zone("Resources::loadDxMusic");
   auto u = Tempest::TextCodec::toUtf16(std::string(name));
   return dxMusic->load(u.c_str());
   }
 
 Tempest::Sound Resources::implLoadSoundBuffer(std::string_view name) {
+  Profiler::Zone zone("Resources::loadSoundBuffer");
   if(name.empty())
     return Tempest::Sound();
 
@@ -782,6 +789,7 @@ const Resources::VobTree* Resources::loadVobBundle(std::string_view name) {
   }
 
 const Resources::VobTree* Resources::implLoadVobBundle(std::string_view filename) {
+  Profiler::Zone zone("Resources::loadVobBundle");
   auto cname = std::string(filename);
   auto i     = zenCache.find(cname);
   if(i!=zenCache.end())
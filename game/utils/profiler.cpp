@@ -0,0 +1,148 @@
+#include "profiler.h"
+
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+using namespace Tempest;
+
+struct ProfEvent final {
+  const char* name  = nullptr;
+  uint64_t    begin = 0;
+  uint64_t    end   = 0;
+  uint32_t    frame = 0;
+  };
+
+// per-thread ring buffer; lock is uncontended, unless dump is in progress
+struct ProfThreadLog final {
+  std::mutex             sync;
+  std::vector<ProfEvent> ring;
+  uint64_t               count = 0;
+  uint32_t               tid   = 0;
+  std::string            name;
+  };
+
+static constexpr size_t RingSize = 1u<<15;
+
+static std::mutex                                  logSync;
+static std::vector<std::shared_ptr<ProfThreadLog>> logs;
+static std::atomic<uint32_t>                       frameId{0};
+static thread_local std::shared_ptr<ProfThreadLog> tlsLog;
+
+static const auto epoch = std::chrono::steady_clock::now();
+
+static uint64_t timeNs() {
+  using namespace std::chrono;
+  return uint64_t(duration_cast<nanoseconds>(steady_clock::now()-epoch).count());
+  }
+
+static ProfThreadLog& threadLog() {
+  if(tlsLog==nullptr) {
+    auto log = std::make_shared<ProfThreadLog>();
+    std::lock_guard<std::mutex> guard(logSync);
+    log->tid = uint32_t(logs.size());
+    logs.push_back(log);
+    tlsLog = std::move(log);
+    }
+  return *tlsLog;
+  }
+
+static void writeStr(WFile& f, std::string_view s) {
+  f.write(s.data(),s.size());
+  }
+
+static void writeEscaped(WFile& f, std::string_view s) {
+  for(auto c:s) {
+    if(c=='"' || c=='\\')
+      f.write("\\",1);
+    f.write(&c,1);
+    }
+  }
+
+std::atomic_bool Profiler::enabled{false};
+
+void Profiler::setEnabled(bool e) {
+  enabled.store(e);
+  }
+
+void Profiler::setThreadName(std::string_view name) {
+  auto& log = threadLog();
+  std::lock_guard<std::mutex> guard(log.sync);
+  log.name = name;
+  }
+
+void Profiler::frame() {
+  frameId.fetch_add(1,std::memory_order_relaxed);
+  }
+
+uint64_t Profiler::begin() {
+  return timeNs();
+  }
+
+void Profiler::end(const char* name, uint64_t start) {
+  const uint64_t t   = timeNs();
+  auto&          log = threadLog();
+
+  std::lock_guard<std::mutex> guard(log.sync);
+  if(log.ring.empty())
+    log.ring.resize(RingSize);
+  auto& e = log.ring[log.count%RingSize];
+  e.name  = name;
+  e.begin = start;
+  e.end   = t;
+  e.frame = frameId.load(std::memory_order_relaxed);
+  log.count++;
+  }
+
+bool Profiler::dump(std::string_view file) {
+  std::vector<std::shared_ptr<ProfThreadLog>> threads;
+  {
+    std::lock_guard<std::mutex> guard(logSync);
+    threads = logs;
+  }
+
+  try {
+    WFile f{std::string(file)};
+    char  buf[256] = {};
+    bool  first    = true;
+
+    writeStr(f,"{\"traceEvents\":[\n");
+    for(auto& pl:threads) {
+      auto& log = *pl;
+      std::lock_guard<std::mutex> guard(log.sync);
+      if(!log.name.empty()) {
+        std::snprintf(buf,sizeof(buf),"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"",
+                      first ? "" : ",\n", unsigned(log.tid));
+        writeStr(f,buf);
+        writeEscaped(f,log.name);
+        writeStr(f,"\"}}");
+        first = false;
+        }
+
+      const uint64_t cnt = std::min<uint64_t>(log.count,RingSize);
+      for(uint64_t i=log.count-cnt; i<log.count; ++i) {
+        auto& e = log.ring[i%RingSize];
+        writeStr(f,first ? "{\"name\":\"" : ",\n{\"name\":\"");
+        writeEscaped(f,e.name);
+        std::snprintf(buf,sizeof(buf),"\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                      unsigned(log.tid), double(e.begin)/1000.0, double(e.end-e.begin)/1000.0, unsigned(e.frame));
+        writeStr(f,buf);
+        first = false;
+        }
+      }
+    writeStr(f,"\n]}\n");
+    }
+  catch(...) {
+    Log::e("unable to write profiler trace: \"",file,"\"");
+    return false;
+    }
+  Log::i("profiler trace written: \"",file,"\"");
+  return true;
+  }
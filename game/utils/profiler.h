@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+class Profiler final {
+  public:
+    // scoped cpu-zone; name must be a string literal (stored by pointer)
+    class Zone final {
+      public:
+        explicit Zone(const char* name) {
+          if(isEnabled()) {
+            this->name = name;
+            start      = begin();
+            }
+          }
+        ~Zone() {
+          if(name!=nullptr)
+            end(name,start);
+          }
+        Zone(const Zone&) = delete;
+        Zone& operator = (const Zone&) = delete;
+
+      private:
+        const char* name  = nullptr;
+        uint64_t    start = 0;
+      };
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool e);
+
+    static void setThreadName(std::string_view name);
+    static void frame();
+
+    // writes chrome://tracing (trace_event) json
+    static bool dump(std::string_view file);
+
+  private:
+    static uint64_t         begin();
+    static void             end(const char* name, uint64_t start);
+
+    static std::atomic_bool enabled;
+  };
@@ -0,0 +1,44 @@
+#include "stringpool.h"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+struct StringTable final {
+  std::mutex                           sync;
+  std::deque<std::string>              storage; // deque: strings are never relocated
+  std::unordered_set<std::string_view> index;
+  };
+
+static StringTable& table() {
+  static StringTable t;
+  return t;
+  }
+
+std::string_view StringPool::intern(std::string_view s) {
+  if(s.empty())
+    return std::string_view();
+
+  // pooled strings are never freed, so views of other threads can be cached without lock
+  thread_local std::unordered_set<std::string_view> local;
+  auto lt = local.find(s);
+  if(lt!=local.end())
+    return *lt;
+
+  auto& t = table();
+  std::lock_guard<std::mutex> guard(t.sync);
+  auto it = t.index.find(s);
+  if(it==t.index.end()) {
+    auto& str = t.storage.emplace_back(s);
+    it = t.index.insert(str).first;
+    }
+  local.insert(*it);
+  return *it;
+  }
+
+size_t StringPool::size() {
+  auto& t = table();
+  std::lock_guard<std::mutex> guard(t.sync);
+  return t.storage.size();
+  }
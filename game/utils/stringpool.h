@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string_view>
+
+// process-wide table of immutable strings; returned views stay valid until exit
+// strings are never freed: intern only names from a bounded set (animations, waypoints, mobsi, output units),
+// not text that scripts build at runtime
+class StringPool final {
+  public:
+    StringPool() = delete;
+
+    static std::string_view intern(std::string_view s);
+    static size_t           size();
+  };
@@ -2,6 +2,8 @@
 
 #include <Tempest/Log>
 
+#include "utils/profiler.h"
+
 #if defined(_MSC_VER)
 #include <windows.h>
 
@@ -38,20 +40,31 @@ void setThreadName(const char* threadName){ (void)threadName; }
 
 using namespace Tempest;
 
+// index of the Workers thread, running on this thread; -1 for any external thread
+static thread_local size_t workerId = size_t(-1);
+
 Workers::Workers() {
-  size_t id=0;
-  for(auto& i:th) {
-    i = std::thread([this,id]() noexcept {
+  size_t cnt = std::thread::hardware_concurrency();
+  cnt = std::max<size_t>(cnt,2)-1; // calling thread participates in work as well
+
+  queues.resize(cnt);
+  for(auto& i:queues)
+    i.reset(new Queue());
+
+  th.resize(cnt);
+  for(size_t id=0; id<cnt; ++id) {
+    th[id] = std::thread([this,id]() noexcept {
       threadFunc(id);
       });
-    ++id;
     }
   }
 
 Workers::~Workers() {
-  running   = false;
-  workTasks = MAX_THREADS;
-  execWork();
+  {
+    std::unique_lock<std::mutex> lck(sync);
+    running.store(false);
+  }
+  workWait.notify_all();
   for(auto& i:th)
     i.join();
   }
@@ -66,47 +79,131 @@ void Workers::threadFunc(size_t id) {
   char buf[128] = {};
   std::snprintf(buf, sizeof(buf), "Workers [%d]", int(id));
   setThreadName(buf);
+  Profiler::setThreadName(buf);
   }
+  workerId = id;
+
   while(true) {
+    Task t;
+    if(pop(t) || steal(t,id)) {
+      execTask(t);
+      continue;
+      }
+
+    sleeping.fetch_add(1);
     {
-    std::unique_lock<std::mutex> lck(sync);
-    while(!workInc[id])
-      workWait.wait(lck);
-    workInc[id]=false;
+      std::unique_lock<std::mutex> lck(sync);
+      workWait.wait(lck,[this](){ return queued.load()>0 || !running.load(); });
     }
+    sleeping.fetch_sub(1);
 
-    if(!running) {
-      workDone.fetch_add(1);
+    if(!running.load())
       return;
-      }
+    }
+  }
 
-    size_t b = std::min((id  )*batchSize, workSize);
-    size_t e = std::min((id+1)*batchSize, workSize);
-    // Log::d("worker: id = ",id," [",b, ", ",e,"]");
+void Workers::execGroup(Group& g, size_t size) {
+  g.pending.store(size);
+  push(Task{&g,0,size});
+  wait(g);
+  }
 
-    if(b!=e) {
-      void* d = workSet + b*workEltSize;
-      workFunc(d,e-b);
-      }
+void Workers::execTask(Task t) {
+  Group& g = *t.group;
+  // lazy binary splitting: keep left half, expose right half for stealing
+  while(t.end-t.begin>g.grain) {
+    size_t mid = t.begin + (t.end-t.begin)/2;
+    push(Task{t.group,mid,t.end});
+    t.end = mid;
+    }
+
+  g.exec(g.ctx,t.begin,t.end);
 
-    if(size_t(workDone.fetch_add(1)+1)==workTasks)
-      std::this_thread::yield();
+  const size_t cnt = t.end-t.begin;
+  if(g.pending.fetch_sub(cnt,std::memory_order_acq_rel)==cnt) {
+    // notify under lock: waiter cannot release the group, until we are done with it
+    std::unique_lock<std::mutex> lck(g.sync);
+    g.finished = true;
+    g.done.notify_all();
     }
   }
 
-void Workers::execWork() {
+void Workers::push(const Task& t) {
+  Queue& q = workerId<queues.size() ? *queues[workerId] : global;
   {
-    std::unique_lock<std::mutex> lck(sync);
-    for(size_t i=0; i<workTasks; ++i)
-      workInc[i]=true;
-    workWait.notify_all();
+    std::unique_lock<std::mutex> lck(q.sync);
+    q.tasks.push_back(t);
+  }
+  queued.fetch_add(1);
+  if(sleeping.load()>0) {
+    { std::unique_lock<std::mutex> lck(sync); }
+    workWait.notify_one();
+    }
   }
-  std::this_thread::yield();
 
-  while(true) {
-    int expect = int(workTasks);
-    if(workDone.compare_exchange_strong(expect,0,std::memory_order::acq_rel))
-      break;
+bool Workers::pop(Task& t) {
+  if(workerId>=queues.size())
+    return false;
+  Queue& q = *queues[workerId];
+  std::unique_lock<std::mutex> lck(q.sync);
+  if(q.tasks.empty())
+    return false;
+  t = q.tasks.back();
+  q.tasks.pop_back();
+  queued.fetch_sub(1);
+  return true;
+  }
+
+bool Workers::steal(Task& t, size_t self) {
+  if(queued.load()==0)
+    return false;
+
+  auto tryTake = [this,&t](Queue& q) {
+    std::unique_lock<std::mutex> lck(q.sync, std::try_to_lock);
+    if(!lck.owns_lock() || q.tasks.empty())
+      return false;
+    t = q.tasks.front();
+    q.tasks.pop_front();
+    queued.fetch_sub(1);
+    return true;
+    };
+
+  {
+    std::unique_lock<std::mutex> lck(global.sync);
+    if(!global.tasks.empty()) {
+      t = global.tasks.front();
+      global.tasks.pop_front();
+      queued.fetch_sub(1);
+      return true;
+      }
+  }
+
+  const size_t cnt = queues.size();
+  for(size_t i=1; i<=cnt; ++i) {
+    size_t victim = (self+i)%cnt;
+    if(victim==self)
+      continue;
+    if(tryTake(*queues[victim]))
+      return true;
+    }
+  return false;
+  }
+
+void Workers::wait(Group& g) {
+  // help with any available work, instead of blocking: makes nested parallelFor safe
+  const size_t self = workerId<queues.size() ? workerId : queues.size();
+  uint32_t     idle = 0;
+  while(g.pending.load(std::memory_order_acquire)!=0 && idle<64) {
+    Task t;
+    if(pop(t) || steal(t,self)) {
+      execTask(t);
+      idle = 0;
+      continue;
+      }
+    ++idle;
     std::this_thread::yield();
     }
+
+  std::unique_lock<std::mutex> lck(g.sync);
+  g.done.wait(lck,[&g](){ return g.finished; });
   }
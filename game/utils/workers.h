@@ -3,11 +3,13 @@
 #include <thread>
 #include <mutex>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <functional>
 #include <atomic>
+#include <cstdint>
 #include <algorithm>
 #include <condition_variable>
-#include <new>
 
 class Workers final {
   public:
@@ -16,12 +18,12 @@ class Workers final {
 
     template<class T,class F>
     static void parallelFor(T* b, T* e, const F& func) {
-      inst().runParallelFor(b,std::distance(b,e),std::thread::hardware_concurrency(),func);
+      inst().runParallelFor(b,size_t(std::distance(b,e)),size_t(-1),func);
       }
 
     template<class T,class F>
     static void parallelFor(std::vector<T>& data, const F& func) {
-      inst().runParallelFor(data.data(),data.size(),std::thread::hardware_concurrency(),func);
+      inst().runParallelFor(data.data(),data.size(),size_t(-1),func);
       }
 
     template<class T,class F>
@@ -31,7 +33,7 @@ class Workers final {
 
     template<class T,class F>
     static void parallelTasks(std::vector<T>& data, const F& func) {
-      inst().runParallelFor2(data.data(),data.size(),std::thread::hardware_concurrency(),func);
+      inst().runParallelTasks(data.data(),data.size(),func);
       }
 
     template<class F>
@@ -40,91 +42,103 @@ class Workers final {
       }
 
     static uint8_t maxThreads() {
-      uint32_t th = std::thread::hardware_concurrency();
-      if(th>MAX_THREADS)
-        return MAX_THREADS;
-      return uint8_t(th);
+      size_t th = inst().threadCount();
+      return uint8_t(std::min<size_t>(th,255));
       }
 
   private:
-    enum { MAX_THREADS=16 };
+    // range of work shared by all tasks spawned from one parallelFor/parallelTasks call
+    struct Group final {
+      void                (*exec)(const void* ctx, size_t b, size_t e) = nullptr;
+      const void*         ctx   = nullptr;
+      size_t              grain = 1;
+      std::atomic<size_t> pending{0};
+
+      std::mutex          sync;
+      std::condition_variable done;
+      bool                finished = false;
+      };
+
+    struct Task final {
+      Group*  group = nullptr;
+      size_t  begin = 0;
+      size_t  end   = 0;
+      };
+
+    // per-thread deque: owner works LIFO on the back, thieves take from the front
+    struct alignas(64) Queue final {
+      std::mutex        sync;
+      std::deque<Task>  tasks;
+      };
 
-    void threadFunc(size_t id);
-    void execWork();
     static Workers& inst();
+    size_t          threadCount() const { return th.size()+1; }
+
+    void            threadFunc(size_t id);
+    void            execGroup(Group& g, size_t size);
+    void            execTask(Task t);
+    void            push(const Task& t);
+    bool            pop(Task& t);
+    bool            steal(Task& t, size_t self);
+    void            wait(Group& g);
+
+    template<class Fn>
+    void runRange(size_t sz, size_t grain, const Fn& fn) {
+      if(sz==0)
+        return;
+      if(sz<=grain || th.empty()) {
+        fn(0,sz);
+        return;
+        }
+      Group g;
+      g.ctx   = &fn;
+      g.grain = std::max<size_t>(grain,1);
+      g.exec  = [](const void* ctx, size_t b, size_t e) {
+        (*reinterpret_cast<const Fn*>(ctx))(b,e);
+        };
+      execGroup(g,sz);
+      }
 
     template<class T,class F>
     void runParallelFor(T* data, size_t sz, size_t maxTh, const F& func) {
-      workSet     = reinterpret_cast<uint8_t*>(data);
-      workSize    = sz;
-      workEltSize = sizeof(T);
-
-      workFunc = [&func](void* data,size_t sz) {
-        T* tdata = reinterpret_cast<T*>(data);
-        for(size_t i=0;i<sz;++i)
-          func(tdata[i]);
-        };
-
-      if(maxTh>MAX_THREADS)
-        workTasks = MAX_THREADS; else
-        workTasks = maxTh;
-
-      batchSize = std::max<size_t>(16,(sz+workTasks-1)/workTasks);
-      execWork();
+      size_t grain = 0;
+      if(maxTh==size_t(-1))
+        grain = (sz+threadCount()*4-1)/(threadCount()*4); else
+        grain = (sz+maxTh-1)/std::max<size_t>(maxTh,1);
+      grain = std::max<size_t>(16,grain);
+
+      runRange(sz,grain,[data,&func](size_t b, size_t e) {
+        for(size_t i=b; i<e; ++i)
+          func(data[i]);
+        });
       }
 
     template<class T,class F>
-    void runParallelFor2(T* data, size_t sz, size_t maxTh, const F& func) {
-      workTasks   = std::min<size_t>(MAX_THREADS, sz);
-      workTasks   = std::min<size_t>(workTasks,  maxTh);
-      workSize    = workTasks;
-      batchSize   = 1;
-      workEltSize = 0;
-
-      workSet     = reinterpret_cast<uint8_t*>(data);
-      taskDone.store(0);
-      workFunc = [this, &func, sz](void* data, size_t /*sz*/) {
-        T* tdata = reinterpret_cast<T*>(data);
-        const size_t increment = (64+sizeof(T)-1)/sizeof(T);
-        while(true) {
-          size_t id = taskDone.fetch_add(increment);
-          for(size_t i=0;i<increment;++i) {
-            if(id+i<sz)
-              func(tdata[id+i]);
-            }
-
-          if(id+increment>=sz)
-            break;
-          }
-        };
-      execWork();
+    void runParallelTasks(T* data, size_t sz, const F& func) {
+      // one cache-line worth of elements per task
+      const size_t grain = (64+sizeof(T)-1)/sizeof(T);
+      runRange(sz,grain,[data,&func](size_t b, size_t e) {
+        for(size_t i=b; i<e; ++i)
+          func(data[i]);
+        });
       }
 
     template<class F>
     void runParallelTasks(size_t taskCount, const F& func) {
-      workTasks   = taskCount;
-      workSize    = taskCount;
-      batchSize   = 1;
-      workSet     = nullptr;
-      workEltSize = 1;
-      workFunc = [&func](void* data, size_t sz) {
-        func(reinterpret_cast<uintptr_t>(data));
-        };
-      execWork();
+      runRange(taskCount,1,[&func](size_t b, size_t e) {
+        for(size_t i=b; i<e; ++i)
+          func(uintptr_t(i));
+        });
       }
 
-    std::thread                       th     [MAX_THREADS];
-    bool                              workInc[MAX_THREADS] = {};
-
-    bool                              running=true;
+    std::vector<std::thread>            th;
+    std::vector<std::unique_ptr<Queue>> queues;
+    Queue                               global;
 
-    uint8_t*                          workSet=nullptr;
-    size_t                            workSize=0, batchSize=0, workEltSize=0;
-    size_t                            workTasks=0;
-    std::function<void(void*,size_t)> workFunc;
+    std::atomic_bool                    running{true};
+    std::atomic<size_t>                 queued{0};
+    std::atomic<size_t>                 sleeping{0};
 
-    std::mutex                        sync;
-    std::condition_variable           workWait;
-    std::atomic_int                   workDone{0};
-    std::atomic_int                   taskDone{0};
+    std::mutex                          sync;
+    std::condition_variable             workWait;
   };
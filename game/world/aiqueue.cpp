@@ -1,75 +1,117 @@
 #include "aiqueue.h"
 
+#include <algorithm>
 #include <limits>
 #include "game/serialize.h"
+#include "utils/stringpool.h"
 
 AiQueue::AiQueue() {  
   }
 
 void AiQueue::save(Serialize& fout) const {
-  fout.write(uint32_t(aiActions.size()));
-  for(auto& i:aiActions){
+  fout.write(uint32_t(count));
+  for(size_t id=0; id<count; ++id){
+    auto& i = at(id);
     fout.write(uint32_t(i.act));
     fout.write(i.target,i.victum);
-    fout.write(i.point,i.func,i.i0,i.i1,i.s0);
+    fout.write(i.point,i.func,i.i0,i.i1);
     if(i.act==AI_PrintScreen)
-      fout.write(i.i2,i.s1);
+      fout.write(i.text,i.i2,i.s1); else
+      fout.write(i.s0);
     }
   }
 
 void AiQueue::load(Serialize& fin) {
   uint32_t size = 0;
   fin.read(size);
-  aiActions.resize(size);
-  for(auto& i:aiActions){
+  clear();
+  reserve(size);
+  count = size;
+
+  std::string s0, s1;
+  for(size_t id=0; id<count; ++id){
+    auto& i = at(id);
+    i = AiAction();
     fin.read(reinterpret_cast<uint32_t&>(i.act));
     fin.read(i.target,i.victum);
-    fin.read(i.point,i.func,i.i0,i.i1,i.s0);
-    if(i.act==AI_PrintScreen)
-      fin.read(i.i2,i.s1);
+    fin.read(i.point,i.func,i.i0,i.i1);
+    if(i.act==AI_PrintScreen) {
+      fin.read(i.text,i.i2,s1);
+      i.s1 = StringPool::intern(s1);
+      } else {
+      fin.read(s0);
+      i.s0 = StringPool::intern(s0);
+      }
     }
   }
 
 void AiQueue::clear() {
-  aiActions.clear();
+  head  = 0;
+  count = 0;
+  }
+
+void AiQueue::reserve(size_t sz) {
+  if(sz<=ring.size())
+    return;
+  size_t cap = std::max(ring.size(),MinCapacity);
+  while(cap<sz)
+    cap *= 2;
+
+  std::vector<AiAction> r(cap);
+  for(size_t i=0; i<count; ++i)
+    r[i] = std::move(at(i));
+  ring = std::move(r);
+  head = 0;
   }
 
 void AiQueue::pushBack(AiAction&& a) {
-  if(aiActions.size()>0) {
-    if(aiActions.back().act==AI_LookAt && a.act==AI_LookAt) {
-      aiActions.back() = a;
+  if(count>0) {
+    auto& back = at(count-1);
+    if(back.act==AI_LookAt && a.act==AI_LookAt) {
+      back = std::move(a);
       return;
       }
     }
-  aiActions.push_back(a);
+  reserve(count+1);
+  at(count) = std::move(a);
+  count++;
   }
 
 void AiQueue::pushFront(AiQueue::AiAction&& a) {
   if(a.act!=AI_PrintScreen) {
     assert(a.i2==0);
     assert(a.s1.empty());
+    assert(a.text.empty());
     }
-  aiActions.push_front(a);
+  reserve(count+1);
+  head = (head+ring.size()-1)&(ring.size()-1);
+  at(0) = std::move(a);
+  count++;
   }
 
 AiQueue::AiAction AiQueue::pop() {
-  auto act = std::move(aiActions.front());
-  aiActions.pop_front();
+  auto act = std::move(at(0));
+  head = (head+1)&(ring.size()-1);
+  count--;
   return act;
   }
 
 int AiQueue::aiOutputOrderId() const {
   int v = std::numeric_limits<int>::max();
-  for(auto& i:aiActions)
+  for(size_t id=0; id<count; ++id) {
+    auto& i = at(id);
     if(i.i0<v && (i.act==AI_Output || i.act==AI_OutputSvm || i.act==AI_OutputSvmOverlay))
       v = i.i0;
+    }
   return v;
   }
 
 void AiQueue::onWldItemRemoved(const Item& itm) {
-  for(auto& i:aiActions)
+  for(size_t id=0; id<count; ++id) {
+    auto& i = at(id);
     if(i.item==&itm)
       i.item = nullptr;
+    }
   }
 
 AiQueue::AiAction AiQueue::aiLookAt(Npc* other) {
@@ -108,7 +150,7 @@ AiQueue::AiAction AiQueue::aiGoToNpc(Npc *other) {
 AiQueue::AiAction AiQueue::aiGoToNextFp(std::string_view fp) {
   AiAction a;
   a.act = AI_GoToNextFp;
-  a.s0  = fp;
+  a.s0  = StringPool::intern(fp);
   return a;
   }
 
@@ -117,7 +159,7 @@ AiQueue::AiAction AiQueue::aiStartState(ScriptFn stateFn, int behavior, Npc* oth
   a.act    = AI_StartState;
   a.func   = stateFn;
   a.i0     = behavior;
-  a.s0     = wp;
+  a.s0     = StringPool::intern(wp);
   a.target = other;
   a.victum = victum;
   return a;
@@ -126,14 +168,14 @@ AiQueue::AiAction AiQueue::aiStartState(ScriptFn stateFn, int behavior, Npc* oth
 AiQueue::AiAction AiQueue::aiPlayAnim(std::string_view ani) {
   AiAction a;
   a.act  = AI_PlayAnim;
-  a.s0   = ani;
+  a.s0   = StringPool::intern(ani);
   return a;
   }
 
 AiQueue::AiAction AiQueue::aiPlayAnimBs(std::string_view ani, BodyState bs) {
   AiAction a;
   a.act  = AI_PlayAnimBs;
-  a.s0   = ani;
+  a.s0   = StringPool::intern(ani);
   a.i0   = int(bs);
   return a;
   }
@@ -192,7 +234,7 @@ AiQueue::AiAction AiQueue::aiEquipBestRangeWeapon() {
 AiQueue::AiAction AiQueue::aiUseMob(std::string_view name, int st) {
   AiAction a;
   a.act = AI_UseMob;
-  a.s0  = name;
+  a.s0  = StringPool::intern(name);
   a.i0  = st;
   return a;
   }
@@ -284,7 +326,7 @@ AiQueue::AiAction AiQueue::aiProcessInfo(Npc &other) {
 AiQueue::AiAction AiQueue::aiOutput(Npc& to, std::string_view  text, int order) {
   AiAction a;
   a.act    = AI_Output;
-  a.s0     = text;
+  a.s0     = StringPool::intern(text);
   a.target = &to;
   a.i0     = order;
   return a;
@@ -293,7 +335,7 @@ AiQueue::AiAction AiQueue::aiOutput(Npc& to, std::string_view  text, int order)
 AiQueue::AiAction AiQueue::aiOutputSvm(Npc &to, std::string_view  text, int order) {
   AiAction a;
   a.act    = AI_OutputSvm;
-  a.s0     = text;
+  a.s0     = StringPool::intern(text);
   a.target = &to;
   a.i0     = order;
   return a;
@@ -302,7 +344,7 @@ AiQueue::AiAction AiQueue::aiOutputSvm(Npc &to, std::string_view  text, int orde
 AiQueue::AiAction AiQueue::aiOutputSvmOverlay(Npc &to, std::string_view  text, int order) {
   AiAction a;
   a.act    = AI_OutputSvmOverlay;
-  a.s0     = text;
+  a.s0     = StringPool::intern(text);
   a.target = &to;
   a.i0     = order;
   return a;
@@ -393,8 +435,8 @@ AiQueue::AiAction AiQueue::aiPrintScreen(int time, std::string_view font, int x,
   a.act    = AI_PrintScreen;
   a.i0     = x;
   a.i1     = y;
-  a.s0     = msg;
+  a.text   = msg;
   a.i2     = time;
-  a.s1     = font;
+  a.s1     = StringPool::intern(font);
   return a;
   }
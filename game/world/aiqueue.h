@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
-#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "game/gamescript.h"
 #include "game/constants.h"
@@ -24,16 +26,17 @@ class AiQueue {
       ScriptFn          func  =0;
       int               i0    =0;
       int               i1    =0;
-      std::string       s0;
+      std::string_view  s0;     // interned, see StringPool; symbolic names only
       // Extended section, only for print-screen
       int               i2    =0;
-      std::string       s1;
+      std::string_view  s1;
+      std::string       text;   // free-form message, not interned
       };
 
     void     save(Serialize& fout) const;
     void     load(Serialize& fin);
 
-    size_t   size() const { return aiActions.size(); }
+    size_t   size() const { return count; }
     void     clear();
     void     pushBack (AiAction&& a);
     void     pushFront(AiAction&& a);
@@ -91,6 +94,15 @@ class AiQueue {
     static AiAction aiPrintScreen(int time, std::string_view font, int x,int y, std::string_view msg);
 
   private:
-    std::deque<AiAction> aiActions;
+    // ring buffer; storage is reused and only grows, so steady-state push/pop doesn't allocate
+    static constexpr size_t MinCapacity = 8;
+
+    AiAction&       at(size_t i)       { return ring[(head+i)&(ring.size()-1)]; }
+    const AiAction& at(size_t i) const { return ring[(head+i)&(ring.size()-1)]; }
+    void            reserve(size_t sz);
+
+    std::vector<AiAction> ring;  // power of two size
+    size_t                head  = 0;
+    size_t                count = 0;
   };
 
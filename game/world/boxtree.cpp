@@ -0,0 +1,65 @@
+#include "boxtree.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+
+void BoxTree::build(std::vector<Box>&& b) {
+  boxes = std::move(b);
+  nodes.clear();
+  if(boxes.empty())
+    return;
+  nodes.reserve(2*(boxes.size()/LeafSize+1));
+  nodes.emplace_back();
+  buildNode(0,0,uint32_t(boxes.size()),0);
+  }
+
+void BoxTree::clear() {
+  nodes.clear();
+  boxes.clear();
+  }
+
+void BoxTree::buildNode(uint32_t node, uint32_t begin, uint32_t end, uint32_t depth) {
+  Vec3 bmin = boxes[begin].min, bmax = boxes[begin].max;
+  Vec3 cmin = (bmin+bmax)*0.5f, cmax = cmin;
+  for(uint32_t i=begin+1; i<end; ++i) {
+    auto& b = boxes[i];
+    auto  c = (b.min+b.max)*0.5f;
+    bmin = Vec3(std::min(bmin.x,b.min.x),std::min(bmin.y,b.min.y),std::min(bmin.z,b.min.z));
+    bmax = Vec3(std::max(bmax.x,b.max.x),std::max(bmax.y,b.max.y),std::max(bmax.z,b.max.z));
+    cmin = Vec3(std::min(cmin.x,c.x),std::min(cmin.y,c.y),std::min(cmin.z,c.z));
+    cmax = Vec3(std::max(cmax.x,c.x),std::max(cmax.y,c.y),std::max(cmax.z,c.z));
+    }
+  nodes[node].min = bmin;
+  nodes[node].max = bmax;
+
+  if(end-begin<=LeafSize || depth>=MaxDepth) {
+    nodes[node].first = begin;
+    nodes[node].count = end-begin;
+    return;
+    }
+
+  // median split along longest axis of box centers
+  const Vec3 ext  = cmax-cmin;
+  int        axis = 0;
+  if(ext.y>ext.x)
+    axis = 1;
+  if(ext.z>(axis==0 ? ext.x : ext.y))
+    axis = 2;
+  auto center = [axis](const Box& b) {
+    auto c = (b.min+b.max);
+    return axis==0 ? c.x : (axis==1 ? c.y : c.z);
+    };
+  const uint32_t mid = begin+(end-begin)/2;
+  std::nth_element(boxes.begin()+begin,boxes.begin()+mid,boxes.begin()+end,[&center](const Box& a, const Box& b){
+    return center(a)<center(b);
+    });
+
+  const uint32_t left = uint32_t(nodes.size());
+  nodes[node].first = left;
+  nodes[node].count = 0;
+  nodes.emplace_back();
+  nodes.emplace_back();
+  buildNode(left,  begin,mid,depth+1);
+  buildNode(left+1,mid,  end,depth+1);
+  }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <vector>
+#include <cstdint>
+
+// static bounding-volume hierarchy over axis aligned boxes; rebuild to update
+class BoxTree final {
+  public:
+    BoxTree() = default;
+
+    struct Box final {
+      Tempest::Vec3 min, max;
+      uint32_t      id = 0;
+      };
+
+    void   build(std::vector<Box>&& boxes);
+    void   clear();
+    size_t size() const { return boxes.size(); }
+
+    // visits id of every box, that contains p (bounds inclusive)
+    template<class F>
+    void   find(const Tempest::Vec3& p, const F& f) const;
+
+  private:
+    struct Node final {
+      Tempest::Vec3 min, max;
+      uint32_t      first = 0; // leaf: first box; inner: left child, right child is first+1
+      uint32_t      count = 0; // 0, for inner nodes
+      };
+
+    static constexpr uint32_t LeafSize = 4;
+    static constexpr uint32_t MaxDepth = 64;
+
+    static bool isInside(const Tempest::Vec3& min, const Tempest::Vec3& max, const Tempest::Vec3& p) {
+      return min.x<=p.x && p.x<=max.x &&
+             min.y<=p.y && p.y<=max.y &&
+             min.z<=p.z && p.z<=max.z;
+      }
+
+    void   buildNode(uint32_t node, uint32_t begin, uint32_t end, uint32_t depth);
+
+    std::vector<Node> nodes;
+    std::vector<Box>  boxes;
+  };
+
+template<class F>
+void BoxTree::find(const Tempest::Vec3& p, const F& f) const {
+  if(nodes.empty())
+    return;
+  uint32_t stk[MaxDepth+1] = {};
+  uint32_t sp = 0;
+  stk[sp++] = 0;
+  while(sp>0) {
+    auto& n = nodes[stk[--sp]];
+    if(!isInside(n.min,n.max,p))
+      continue;
+    if(n.count>0) {
+      for(uint32_t i=n.first; i<n.first+n.count; ++i)
+        if(isInside(boxes[i].min,boxes[i].max,p))
+          f(boxes[i].id);
+      continue;
+      }
+    stk[sp++] = n.first+1;
+    stk[sp++] = n.first;
+    }
+  }
@@ -130,5 +130,17 @@ void CollisionZone::setCallback(std::function<void(Npc&)> f) {
   }
 
 void CollisionZone::setPosition(const Tempest::Vec3& p) {
+  if(pos.x==p.x && pos.y==p.y && pos.z==p.z)
+    return;
   pos = p;
+  if(owner!=nullptr)
+    owner->invalidateCollizionZone(*this);
+  }
+
+void CollisionZone::bbox(Tempest::Vec3& min, Tempest::Vec3& max) const {
+  Tempest::Vec3 ext = size;
+  if(type==T_Capsule)
+    ext = Tempest::Vec3(std::fabs(size.x),std::fabs(size.y),std::fabs(size.x));
+  min = pos-ext;
+  max = pos+ext;
   }
@@ -26,6 +26,8 @@ class CollisionZone final {
 
     Tempest::Vec3 position() const { return pos; }
     void          setPosition(const Tempest::Vec3& p);
+    void          bbox(Tempest::Vec3& min, Tempest::Vec3& max) const;
+    bool          isDynamic() const { return pfx!=nullptr; }
 
     const std::vector<Npc*>& intersections() const { return intersect; }
 
@@ -0,0 +1,117 @@
+#include "lineofsight.h"
+
+#include "world/objects/npc.h"
+#include "utils/workers.h"
+#include "world.h"
+
+#include <algorithm>
+#include <cstdio>
+
+LineOfSight::LineOfSight(World& owner)
+  :owner(owner) {
+  }
+
+bool LineOfSight::test(const Npc& observer, const Npc& target) {
+  const Key key = {&observer,&target};
+  if(isFresh(key)) {
+    hit++;
+    return cache[key].visible;
+    }
+  miss++;
+
+  auto r = mkRay(observer,target);
+  r.visible = !owner.physic()->ray(r.from,r.to).hasCol;
+  rays++;
+  cache[key] = Entry{owner.tickCount(),r.visible,false};
+  return r.visible;
+  }
+
+void LineOfSight::submit(const Npc& observer, const Npc& target) {
+  if(cacheTime==0)
+    return;
+  const Key      key  = {&observer,&target};
+  const uint64_t time = owner.tickCount();
+  auto           i    = cache.find(key);
+  if(i!=cache.end() && (i->second.pending || i->second.time+cacheTime>time))
+    return;
+  // mark as pending, to deduplicate queries
+  cache[key] = Entry{time,false,true};
+  queue.push_back(mkRay(observer,target));
+  }
+
+void LineOfSight::flush() {
+  if(queue.empty())
+    return;
+  auto& physic = *owner.physic();
+  Workers::parallelFor(queue,[&physic](Ray& r){
+    r.visible = !physic.ray(r.from,r.to).hasCol;
+    });
+
+  const uint64_t time = owner.tickCount();
+  for(auto& r:queue)
+    cache[r.key] = Entry{time,r.visible,false};
+  rays    += uint32_t(queue.size());
+  batched += queue.size();
+  queue.clear();
+  }
+
+void LineOfSight::erase(const Npc& npc) {
+  for(auto i=cache.begin(); i!=cache.end();) {
+    if(i->first.observer==&npc || i->first.target==&npc)
+      i = cache.erase(i); else
+      ++i;
+    }
+  queue.erase(std::remove_if(queue.begin(),queue.end(),[&npc](const Ray& r){
+    return r.key.observer==&npc || r.key.target==&npc;
+    }),queue.end());
+  }
+
+void LineOfSight::frame() {
+  raysLast   = rays;
+  raysMax    = std::max(raysMax,rays);
+  raysTotal += rays;
+  rays       = 0;
+  frameId++;
+  if(frameId%64==0)
+    prune();
+  }
+
+bool LineOfSight::isFresh(const Key& k) const {
+  auto i = cache.find(k);
+  if(i==cache.end() || i->second.pending)
+    return false;
+  return i->second.time+cacheTime>owner.tickCount();
+  }
+
+LineOfSight::Ray LineOfSight::mkRay(const Npc& observer, const Npc& target) const {
+  // same points, as in Npc::canSenseNpc: npc eyesight height to middle of target
+  Ray r;
+  r.key  = Key{&observer,&target};
+  r.from = observer.mapHeadBone();
+  r.to   = target.bounds().midTr;
+  return r;
+  }
+
+void LineOfSight::prune() {
+  const uint64_t time = owner.tickCount();
+  for(auto i=cache.begin(); i!=cache.end();) {
+    if(i->second.time+cacheTime<=time)
+      i = cache.erase(i); else
+      ++i;
+    }
+  }
+
+void LineOfSight::dumpStats(const std::function<void(std::string_view)>& out) const {
+  char buf[256] = {};
+  const uint64_t total = hit+miss;
+  std::snprintf(buf,sizeof(buf),"los: rays last frame: %u, max: %u, avg: %.1f, batched: %llu",
+                unsigned(raysLast),unsigned(raysMax),
+                frameId==0 ? 0.0 : double(raysTotal)/double(frameId),
+                static_cast<unsigned long long>(batched));
+  out(buf);
+  std::snprintf(buf,sizeof(buf),"  cache: %d pairs, %d ms, hit: %llu, miss: %llu (%.1f%%)",
+                int(cache.size()),int(cacheTime),
+                static_cast<unsigned long long>(hit),static_cast<unsigned long long>(miss),
+                total==0 ? 0.0 : double(hit*100)/double(total));
+  out(buf);
+  }
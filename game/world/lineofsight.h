@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+class Npc;
+class World;
+
+// line-of-sight tests between npc's: cached per (observer,target) pair for a short time
+// and resolved in parallel batches, when queued ahead of perception
+class LineOfSight final {
+  public:
+    explicit LineOfSight(World& owner);
+
+    void     setCacheTime(uint64_t ms) { cacheTime = ms; }
+
+    bool     test  (const Npc& observer, const Npc& target);
+    void     submit(const Npc& observer, const Npc& target);
+    void     flush ();
+    void     erase (const Npc& npc);
+    void     frame ();
+
+    void     dumpStats(const std::function<void(std::string_view)>& out) const;
+
+  private:
+    struct Key final {
+      const Npc* observer = nullptr;
+      const Npc* target   = nullptr;
+      bool operator == (const Key& other) const { return observer==other.observer && target==other.target; }
+      };
+    struct KeyHash final {
+      size_t operator()(const Key& k) const {
+        return std::hash<const void*>()(k.observer) ^ (std::hash<const void*>()(k.target)*31);
+        }
+      };
+    struct Entry final {
+      uint64_t time    = 0;
+      bool     visible = false;
+      bool     pending = false;
+      };
+    struct Ray final {
+      Key           key;
+      Tempest::Vec3 from, to;
+      bool          visible = false;
+      };
+
+    bool     isFresh(const Key& k) const;
+    Ray      mkRay(const Npc& observer, const Npc& target) const;
+    void     prune();
+
+    World&                                owner;
+    uint64_t                              cacheTime = 250;
+    std::unordered_map<Key,Entry,KeyHash> cache;
+    std::vector<Ray>                      queue;
+
+    uint64_t                              frameId   = 0;
+    uint32_t                              rays      = 0;
+    uint32_t                              raysLast  = 0;
+    uint32_t                              raysMax   = 0;
+    uint64_t                              raysTotal = 0;
+    uint64_t                              batched   = 0;
+    uint64_t                              hit       = 0;
+    uint64_t                              miss      = 0;
+  };
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// case-insensitive multimap: object name -> objects; objects of same name are kept in order of insertion
+template<class T>
+class NameIndex final {
+  public:
+    NameIndex() = default;
+
+    void   insert(std::string_view name, T* obj);
+    void   clear() { index.clear(); }
+    size_t size() const { return index.size(); }
+
+    // first inserted object of this name
+    T*     find   (std::string_view name) const;
+    auto   findAll(std::string_view name) const -> const std::vector<T*>&;
+
+  private:
+    static char upper(char c) { return (c>='a' && c<='z') ? char(c-'a'+'A') : c; }
+
+    struct Hash final {
+      using is_transparent = void;
+      size_t operator()(std::string_view s) const {
+        uint64_t h = 14695981039346656037ull;
+        for(auto c:s)
+          h = (h ^ uint8_t(upper(c)))*1099511628211ull;
+        return size_t(h);
+        }
+      };
+    struct Equal final {
+      using is_transparent = void;
+      bool operator()(std::string_view a, std::string_view b) const {
+        if(a.size()!=b.size())
+          return false;
+        for(size_t i=0; i<a.size(); ++i)
+          if(upper(a[i])!=upper(b[i]))
+            return false;
+        return true;
+        }
+      };
+
+    std::unordered_map<std::string,std::vector<T*>,Hash,Equal> index;
+  };
+
+template<class T>
+void NameIndex<T>::insert(std::string_view name, T* obj) {
+  auto it = index.find(name);
+  if(it==index.end())
+    it = index.emplace(std::string(name),std::vector<T*>()).first;
+  it->second.push_back(obj);
+  }
+
+template<class T>
+T* NameIndex<T>::find(std::string_view name) const {
+  auto it = index.find(name);
+  if(it==index.end())
+    return nullptr;
+  return it->second.front();
+  }
+
+template<class T>
+auto NameIndex<T>::findAll(std::string_view name) const -> const std::vector<T*>& {
+  static const std::vector<T*> empty;
+  auto it = index.find(name);
+  if(it==index.end())
+    return empty;
+  return it->second;
+  }
@@ -0,0 +1,37 @@
+#include "npcgrid.h"
+
+void NpcGrid::insert(Npc& npc, const Tempest::Vec3& pos) {
+  if(slots.find(&npc)!=slots.end())
+    return;
+  const uint64_t c  = cellOf(pos.x,pos.z);
+  auto&          cl = cells[c];
+  slots[&npc] = Slot{c,uint32_t(cl.size())};
+  cl.push_back(&npc);
+  }
+
+void NpcGrid::erase(const Npc& npc) {
+  auto it = slots.find(&npc);
+  if(it==slots.end())
+    return;
+  auto  s  = it->second;
+  auto& cl = cells[s.cell];
+  slots.erase(it);
+
+  cl[s.id] = cl.back();
+  cl.pop_back();
+  if(s.id<cl.size())
+    slots[cl[s.id]].id = s.id;
+  }
+
+void NpcGrid::move(Npc& npc, const Tempest::Vec3& pos) {
+  auto it = slots.find(&npc);
+  if(it==slots.end() || it->second.cell==cellOf(pos.x,pos.z))
+    return;
+  erase (npc);
+  insert(npc,pos);
+  }
+
+void NpcGrid::clear() {
+  cells.clear();
+  slots.clear();
+  }
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+class Npc;
+
+// uniform grid in xz-plane; npc is moved to another bucket only, when it crosses cell boundary
+class NpcGrid final {
+  public:
+    NpcGrid() = default;
+
+    static constexpr float CellSize = 20.f*100.f;
+    static uint64_t cellOf(float x, float z);
+
+    void   insert(Npc& npc, const Tempest::Vec3& pos);
+    void   erase (const Npc& npc);
+    void   move  (Npc& npc, const Tempest::Vec3& pos);
+    void   clear();
+    size_t size() const { return slots.size(); }
+
+    // visits every npc in cells, overlapping with [p-R, p+R]; no distance test
+    template<class F>
+    void   find(const Tempest::Vec3& p, float R, const F& f) const;
+
+  private:
+    struct Slot final {
+      uint64_t cell = 0;
+      uint32_t id   = 0;
+      };
+
+    static int32_t cellId(float v) { return int32_t(std::floor(v/CellSize)); }
+    static uint64_t key(int32_t x, int32_t z) { return (uint64_t(uint32_t(x))<<32) | uint64_t(uint32_t(z)); }
+
+    std::unordered_map<uint64_t,std::vector<Npc*>> cells;
+    std::unordered_map<const Npc*,Slot>            slots;
+  };
+
+inline uint64_t NpcGrid::cellOf(float x, float z) {
+  return key(cellId(x),cellId(z));
+  }
+
+template<class F>
+void NpcGrid::find(const Tempest::Vec3& p, float R, const F& f) const {
+  const int32_t x0 = cellId(p.x-R), x1 = cellId(p.x+R);
+  const int32_t z0 = cellId(p.z-R), z1 = cellId(p.z+R);
+  for(int32_t x=x0; x<=x1; ++x)
+    for(int32_t z=z0; z<=z1; ++z) {
+      auto it = cells.find(key(x,z));
+      if(it==cells.end())
+        continue;
+      for(auto npc:it->second)
+        f(*npc);
+      }
+  }
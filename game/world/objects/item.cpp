@@ -139,12 +139,12 @@ void Item::setAsEquiped(bool e) {
 
 void Item::setPhysicsEnable(World& world) {
   setPhysicsEnable(view);
-  world.invalidateVobIndex();
+  world.invalidateVobIndex(*this);
   }
 
 void Item::setPhysicsDisable() {
   physic = DynamicWorld::Item();
-  world.invalidateVobIndex();
+  world.invalidateVobIndex(*this);
   }
 
 void Item::setPhysicsEnable(const MeshObjects::Mesh& view) {
@@ -315,5 +315,5 @@ void Item::moveEvent() {
   view  .setObjMatrix(transform());
   physic.setObjMatrix(transform());
   if(!isDynamic())
-    world.invalidateVobIndex();
+    world.invalidateVobIndex(*this);
   }
@@ -14,6 +14,7 @@
 #include "world/world.h"
 #include "utils/versioninfo.h"
 #include "utils/fileext.h"
+#include "utils/profiler.h"
 #include "camera.h"
 #include "gothic.h"
 #include "resources.h"
@@ -212,6 +213,7 @@ void Npc::save(Serialize &fout, size_t id) {
   fout.write(lastEventTime,angleY,runAng);
   fout.write(invTorch);
   fout.write(isUsingTorch());
+  fout.write(tickDebt);
 
   Vec3 phyPos = physic.position();
   fout.write(phyPos);
@@ -272,6 +274,8 @@ void Npc::load(Serialize &fin, size_t id) {
     fin.read(invTorch);
     fin.read(isUsingTorch);
     }
+  if(fin.version()>40)
+    fin.read(tickDebt);
 
   Vec3 phyPos = {};
   fin.read(phyPos);
@@ -329,6 +333,7 @@ void Npc::loadAiState(Serialize& fin) {
   routines.resize(size);
   for(auto& i:routines)
     fin.read(i.start,i.end,i.callback,i.point);
+  invalidateRoutine();
   }
 
 void Npc::saveTrState(Serialize& fout) const {
@@ -350,11 +355,14 @@ void Npc::loadTrState(Serialize& fin) {
 bool Npc::setPosition(float ix, float iy, float iz) {
   if(x==ix && y==iy && z==iz)
     return false;
+  const bool cell = NpcGrid::cellOf(x,z)!=NpcGrid::cellOf(ix,iz);
   x = ix;
   y = iy;
   z = iz;
   durtyTranform |= TR_Pos;
   physic.setPosition(Vec3{x,y,z});
+  if(cell)
+    owner.invalidateNpcIndex(*this);
   return true;
   }
 
@@ -363,10 +371,13 @@ bool Npc::setPosition(const Tempest::Vec3& pos) {
   }
 
 void Npc::setViewPosition(const Tempest::Vec3& pos) {
+  const bool cell = NpcGrid::cellOf(x,z)!=NpcGrid::cellOf(pos.x,pos.z);
   x = pos.x;
   y = pos.y;
   z = pos.z;
   durtyTranform |= TR_Pos;
+  if(cell)
+    owner.invalidateNpcIndex(*this);
   }
 
 int Npc::aiOutputOrderId() const {
@@ -1792,7 +1803,9 @@ Npc *Npc::updateNearestEnemy() {
     dist = qDistTo(*ret);
     }
 
-  owner.detectNpcNear([this,&ret,&dist](Npc& n){
+  // canSenseNpc tests mid-point of target, search with some margin
+  const float range = float(hnpc->senses_range)+500.f;
+  owner.detectNpc(position(),range,[this,&ret,&dist](Npc& n){
     if(!isEnemy(n) || n.isDown() || &n==this)
       return;
 
@@ -1813,7 +1826,9 @@ Npc* Npc::updateNearestBody() {
   Npc*  ret  = nullptr;
   float dist = std::numeric_limits<float>::max();
 
-  owner.detectNpcNear([this,&ret,&dist](Npc& n){
+  // canSenseNpc tests mid-point of target, search with some margin
+  const float range = float(hnpc->senses_range)+500.f;
+  owner.detectNpc(position(),range,[this,&ret,&dist](Npc& n){
     if(!n.isDead())
       return;
 
@@ -1947,6 +1962,7 @@ void Npc::tickAnimationTags() {
   }
 
 void Npc::tick(uint64_t dt) {
+  Profiler::Zone zone("Npc::tick");
   tickAnimationTags();
 
   if(!visual.pose().hasAnim())
@@ -2003,6 +2019,32 @@ void Npc::tick(uint64_t dt) {
   implAiTick(dt);
   }
 
+uint32_t Npc::tickDeferred(uint64_t step, uint32_t maxSteps) {
+  // steps end at multiples of 'step' in world time, and each step sees world clock at its end:
+  // result doesn't depend on when npc was visited. Time after last boundary stays as debt
+  const uint64_t now = owner.tickCount();
+  uint64_t       at  = now-tickDebt;
+  uint32_t       cnt = 0;
+  while(cnt<maxSteps) {
+    const uint64_t next = (at/step+1)*step;
+    if(next>now)
+      break;
+    tickDebt = now-next;
+    owner.setCatchUpLag(tickDebt);
+    tick(next-at);
+    at = next;
+    ++cnt;
+    }
+  owner.setCatchUpLag(0);
+  return cnt;
+  }
+
+void Npc::tickRemainder() {
+  const uint64_t dt = tickDebt;
+  tickDebt = 0;
+  tick(dt);
+  }
+
 void Npc::nextAiAction(AiQueue& queue, uint64_t dt) {
   if(queue.size()==0)
     return;
@@ -2417,7 +2459,7 @@ void Npc::nextAiAction(AiQueue& queue, uint64_t dt) {
       break;
       }
     case AI_PrintScreen:{
-      auto  msg     = act.s0;
+      auto& msg     = act.text;
       auto  posx    = act.i0;
       auto  posy    = act.i1;
       int   timesec = act.i2;
@@ -2687,19 +2729,62 @@ void Npc::commitSpell() {
   }
 
 const Npc::Routine& Npc::currentRoutine() const {
-  auto time = owner.time();
-  time = gtime(int32_t(time.hour()),int32_t(time.minute()));
-  for(auto& i:routines){
-    if(i.end<i.start && (time<i.end || i.start<=time))
-      return i;
-    if(i.start<=time && time<i.end)
-      return i;
-    }
+  // routine can change only at start/end of one of routines; setDayTime may move time backward
+  auto now = owner.time();
+  if(now<routineFrom || routineUntil<=now)
+    updateRoutine(now);
+  if(routineId<routines.size())
+    return routines[routineId];
 
   static Routine r;
   return r;
   }
 
+void Npc::updateRoutine(gtime now) const {
+  const auto time = gtime(int32_t(now.hour()),int32_t(now.minute()));
+
+  routineId = size_t(-1);
+  for(size_t id=0; id<routines.size(); ++id) {
+    auto& i = routines[id];
+    if(i.end<i.start && (time<i.end || i.start<=time)) {
+      routineId = id;
+      break;
+      }
+    if(i.start<=time && time<i.end) {
+      routineId = id;
+      break;
+      }
+    }
+
+  // next boundary: earliest start/end later today, or earliest one tomorrow
+  gtime next  = gtime::endOfTime();
+  gtime first = gtime::endOfTime();
+  for(auto& i:routines) {
+    for(auto t:{i.start,i.end}) {
+      if(t<first)
+        first = t;
+      if(time<t && t<next)
+        next = t;
+      }
+    }
+
+  // boundaries are offsets from midnight: 24:00 rolls over to the next day
+  routineFrom  = now;
+  routineUntil = gtime::endOfTime();
+  if(next!=gtime::endOfTime()) {
+    routineUntil = gtime(now.day(),int32_t(0),int32_t(0));
+    routineUntil.addMilis(uint64_t(next.toInt()));
+    } else if(first!=gtime::endOfTime()) {
+    routineUntil = gtime(now.day()+1,int32_t(0),int32_t(0));
+    routineUntil.addMilis(uint64_t(first.toInt()));
+    }
+  }
+
+void Npc::invalidateRoutine() {
+  routineFrom  = gtime();
+  routineUntil = gtime();
+  }
+
 gtime Npc::endTime(const Npc::Routine &r) const {
   auto wtime = owner.time();
   auto time  = gtime(int32_t(wtime.hour()),int32_t(wtime.minute()));
@@ -3681,10 +3766,12 @@ void Npc::addRoutine(gtime s, gtime e, uint32_t callback, const WayPoint *point)
   r.callback = callback;
   r.point    = point;
   routines.push_back(r);
+  invalidateRoutine();
   }
 
 void Npc::excRoutine(size_t callback) {
   routines.clear();
+  invalidateRoutine();
   owner.script().invokeState(this,currentOther,currentVictum,callback);
   aiState.eTime = gtime();
   }
@@ -3915,40 +4002,76 @@ bool Npc::canSeeNpc(float tx, float ty, float tz, bool freeLos) const {
 SensesBit Npc::canSenseNpc(const Npc &oth, bool freeLos, float extRange) const {
   const auto mid     = oth.bounds().midTr;
   const bool isNoisy = (oth.bodyState()&BodyState::BS_SNEAK)==0;
-  return canSenseNpc(mid.x,mid.y,mid.z,freeLos,isNoisy,extRange);
+  return canSenseNpc(mid,freeLos,isNoisy,extRange,&oth);
   }
 
 SensesBit Npc::canSenseNpc(float tx, float ty, float tz, bool freeLos, bool isNoisy, float extRange) const {
-  DynamicWorld* w = owner.physic();
+  return canSenseNpc(Vec3(tx,ty,tz),freeLos,isNoisy,extRange,nullptr);
+  }
+
+SensesBit Npc::canSenseNpc(const Tempest::Vec3& t, bool freeLos, bool isNoisy, float extRange, const Npc* oth) const {
   static const double ref = std::cos(100*M_PI/180.0); // spec requires +-100 view angle range
 
   const float range = float(hnpc->senses_range)+extRange;
-  if(qDistTo(tx,ty,tz)>range*range)
+  if(qDistTo(t.x,t.y,t.z)>range*range)
     return SensesBit::SENSE_NONE;
 
   SensesBit ret=SensesBit::SENSE_NONE;
-  if(owner.roomAt({tx,ty,tz})==owner.roomAt({x,y,z})) {
+  // bsp-leaf of npc is cached: most of queries are resolved by bbox test
+  const auto room = (oth!=nullptr) ? owner.roomAt(t,oth->bspLeaf) : owner.roomAt(t);
+  if(room==owner.roomAt({x,y,z},bspLeaf)) {
     ret = ret | SensesBit::SENSE_SMELL;
     if(isNoisy)
       ret = ret | SensesBit::SENSE_HEAR;
     }
 
-  // npc eyesight height
-  auto head = visual.mapHeadBone();
+  if((SensesBit(hnpc->senses) & SensesBit::SENSE_SEE)==SensesBit::SENSE_NONE)
+    return ret & SensesBit(hnpc->senses);
+
+  auto isVisible = [this,&t,oth]() {
+    // line of sight between npc's is cached
+    if(oth!=nullptr)
+      return owner.testLineOfSight(*this,*oth);
+    // npc eyesight height
+    auto head = visual.mapHeadBone();
+    return !owner.physic()->ray(head,t).hasCol;
+    };
+
   if(!freeLos) {
-    float dx  = x-tx, dz=z-tz;
+    float dx  = x-t.x, dz=z-t.z;
     float dir = angleDir(dx,dz);
     float da  = float(M_PI)*(visual.viewDirection()-dir)/180.f;
     if(double(std::cos(da))<=ref)
-      if(!w->ray(head, Vec3(tx,ty,tz)).hasCol)
+      if(isVisible())
         ret = ret | SensesBit::SENSE_SEE;
     } else {
-    if(!w->ray(head, Vec3(tx,ty,tz)).hasCol)
+    if(isVisible())
       ret = ret | SensesBit::SENSE_SEE;
     }
   return ret & SensesBit(hnpc->senses);
   }
 
+void Npc::submitSenseQueries(LineOfSight& los) const {
+  // same candidates, as in updateNearestEnemy and updateNearestBody
+  const bool enemy = hasPerc(PERC_ASSESSENEMY);
+  const bool body  = hasPerc(PERC_ASSESSBODY);
+  if(aiPolicy!=ProcessPolicy::AiNormal || (!enemy && !body))
+    return;
+  if((SensesBit(hnpc->senses) & SensesBit::SENSE_SEE)==SensesBit::SENSE_NONE)
+    return;
+
+  const float range = float(hnpc->senses_range);
+  owner.detectNpc(position(),range+500.f,[&](Npc& n){
+    if(&n==this)
+      return;
+    if(!(enemy && isEnemy(n) && !n.isDown()) && !(body && n.isDead()))
+      return;
+    const auto mid = n.bounds().midTr;
+    if(qDistTo(mid.x,mid.y,mid.z)<=range*range)
+      los.submit(*this,n);
+    });
+  }
+
 bool Npc::canSeeItem(const Item& it, bool freeLos) const {
   DynamicWorld* w = owner.physic();
   static const double ref = std::cos(100*M_PI/180.0); // spec requires +-100 view angle range
@@ -23,6 +23,7 @@
 
 class Interactive;
 class WayPoint;
+class LineOfSight;
 
 class Npc final {
   public:
@@ -110,6 +111,10 @@ class Npc final {
     void       setWalkMode(WalkBit m);
     auto       walkMode() const { return wlkMode; }
     void       tick(uint64_t dt);
+    void       deferTick(uint64_t dt) { tickDebt += dt; }
+    uint64_t   deferredTime() const { return tickDebt; }
+    uint32_t   tickDeferred(uint64_t step, uint32_t maxSteps);
+    void       tickRemainder();
     void       tickAnimationTags();
     bool       startClimb(JumpStatus jump);
 
@@ -366,6 +371,7 @@ class Npc final {
     bool      canSeeNpc(float x,float y,float z,bool freeLos) const;
     auto      canSenseNpc(const Npc& oth,bool freeLos, float extRange=0.f) const -> SensesBit;
     auto      canSenseNpc(float x,float y,float z,bool freeLos,bool isNoisy,float extRange=0.f) const -> SensesBit;
+    void      submitSenseQueries(LineOfSight& los) const;
 
     bool      canSeeItem(const Item& it,bool freeLos) const;
 
@@ -452,6 +458,8 @@ class Npc final {
     bool      performOutput(const AiQueue::AiAction &ai);
 
     auto      currentRoutine() const -> const Routine&;
+    void      updateRoutine(gtime now) const;
+    void      invalidateRoutine();
     gtime     endTime(const Routine& r) const;
 
     bool      implPointAt(const Tempest::Vec3& to);
@@ -476,6 +484,7 @@ class Npc final {
     void      commitDamage();
     Npc*      updateNearestEnemy();
     Npc*      updateNearestBody();
+    auto      canSenseNpc(const Tempest::Vec3& t, bool freeLos, bool isNoisy, float extRange, const Npc* oth) const -> SensesBit;
     bool      checkHealth(bool onChange, bool forceKill);
     void      onNoHealth(bool death, HitSound sndMask);
     bool      hasAutoroll() const;
@@ -516,6 +525,7 @@ class Npc final {
     // visual props (cache)
     uint8_t                        durtyTranform=0;
     Tempest::Vec3                  lastGroundNormal;
+    mutable uint32_t               bspLeaf = uint32_t(-1);
 
     DynamicWorld::NpcItem          physic;
 
@@ -561,11 +571,16 @@ class Npc final {
 
     uint64_t                       aiOutputBarrier=0;
     ProcessPolicy                  aiPolicy=ProcessPolicy::AiNormal;
+    uint64_t                       tickDebt=0; // time, skipped by simulation LOD
     AiState                        aiState;
     ScriptFn                       aiPrevState;
     AiQueue                        aiQueue;
     AiQueue                        aiQueueOverlay;
     std::vector<Routine>           routines;
+    // current routine is valid within [routineFrom, routineUntil) of world time
+    mutable size_t                 routineId    = size_t(-1);
+    mutable gtime                  routineFrom;
+    mutable gtime                  routineUntil;
 
     Interactive*                   currentInteract=nullptr;
     Npc*                           currentOther   =nullptr;
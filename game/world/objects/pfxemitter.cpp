@@ -20,8 +20,10 @@ PfxEmitter::PfxEmitter(World& world, std::string_view name)
   :PfxEmitter(world,Gothic::inst().loadParticleFx(name)) {
   }
 
-PfxEmitter::PfxEmitter(World& world, const ParticleFx* decl)
-  :PfxEmitter(world.view()->pfxGroup,decl) {
+PfxEmitter::PfxEmitter(World& world, const ParticleFx* decl) {
+  if(world.view()==nullptr)
+    return; // headless
+  *this = PfxEmitter(world.view()->pfxGroup,decl);
   }
 
 PfxEmitter::PfxEmitter(PfxObjects& owner, const ParticleFx* decl) {
@@ -36,6 +38,8 @@ PfxEmitter::PfxEmitter(PfxObjects& owner, const ParticleFx* decl) {
   }
 
 PfxEmitter::PfxEmitter(World& world, const phoenix::vob& vob) {
+  if(world.view()==nullptr)
+    return;
   auto& owner = world.view()->pfxGroup;
   if(FileExt::hasExt(vob.visual_name,"PFX")) {
     auto decl = Gothic::inst().loadParticleFx(vob.visual_name);
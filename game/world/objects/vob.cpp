@@ -112,7 +112,7 @@ void Vob::recalculateTransform() {
       case phoenix::vob_type::oCMobSwitch:
       case phoenix::vob_type::oCMobLadder:
       case phoenix::vob_type::oCMobWheel:
-        world.invalidateVobIndex();
+        world.invalidateVobIndex(*this);
         break;
       default:
         break;
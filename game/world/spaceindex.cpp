@@ -4,68 +4,155 @@
 
 void BaseSpaceIndex::clear() {
   arr.clear();
+  slot.clear();
+  lookup.clear();
   index.clear();
   dynamic.clear();
+  pending.clear();
+  holes = 0;
+  dirty = true;
   }
 
 void BaseSpaceIndex::invalidate() {
-  index.clear();
-  dynamic.clear();
+  dirty = true;
+  }
+
+void BaseSpaceIndex::invalidate(const Vob* v) {
+  // object has moved or changed it's dynamic state: reinsert into pending list
+  auto it = lookup.find(v);
+  if(it==lookup.end())
+    return;
+  const uint32_t id = it->second;
+  if(slot[id].loc==L_Pending)
+    return;
+  detach(id);
+  slot[id] = Slot{L_Pending,uint32_t(pending.size())};
+  pending.push_back(id);
   }
 
 void BaseSpaceIndex::add(Vob* v) {
-  arr.push_back(v);
-  index.reserve(arr.size());
-  index.clear();
-  dynamic.clear();
+  const uint32_t id = uint32_t(arr.size());
+  if(!lookup.emplace(v,id).second)
+    return;
+  arr .push_back(v);
+  slot.push_back(Slot{L_Pending,uint32_t(pending.size())});
+  pending.push_back(id);
   }
 
 void BaseSpaceIndex::del(Vob* v) {
-  for(size_t i=0;i<arr.size();++i) {
-    if(arr[i]==v) {
-      arr[i] = arr.back();
-      arr.pop_back();
-      index.clear();
-      dynamic.clear();
-      return;
-      }
+  auto it = lookup.find(v);
+  if(it==lookup.end())
+    return;
+  const uint32_t id   = it->second;
+  const uint32_t last = uint32_t(arr.size()-1);
+  lookup.erase(it);
+  detach(id);
+  if(id!=last) {
+    arr [id] = arr [last];
+    slot[id] = slot[last];
+    lookup[arr[id]] = id;
+    relink(id);
     }
+  arr .pop_back();
+  slot.pop_back();
   }
 
 bool BaseSpaceIndex::hasObject(const Vob* v) const {
   if(v==nullptr)
     return false;
-  for(size_t i=0;i<arr.size();++i)
-    if(arr[i]==v)
-      return true;
-  return false;
+  return lookup.find(v)!=lookup.end();
+  }
+
+uint32_t BaseSpaceIndex::indexOf(const Vob* v) const {
+  if(v==nullptr)
+    return NoObject;
+  auto it = lookup.find(v);
+  if(it==lookup.end())
+    return NoObject;
+  return it->second;
+  }
+
+void BaseSpaceIndex::detach(uint32_t id) {
+  auto& s = slot[id];
+  switch(s.loc) {
+    case L_Index:
+      index[s.id].obj = NoObject;
+      holes++;
+      break;
+    case L_Dynamic:
+      dynamic[s.id] = dynamic.back();
+      slot[dynamic[s.id]].id = s.id;
+      dynamic.pop_back();
+      break;
+    case L_Pending:
+      pending[s.id] = pending.back();
+      slot[pending[s.id]].id = s.id;
+      pending.pop_back();
+      break;
+    }
+  }
+
+void BaseSpaceIndex::relink(uint32_t id) {
+  auto& s = slot[id];
+  switch(s.loc) {
+    case L_Index:
+      index[s.id].obj = id;
+      break;
+    case L_Dynamic:
+      dynamic[s.id] = id;
+      break;
+    case L_Pending:
+      pending[s.id] = id;
+      break;
+    }
+  }
+
+bool BaseSpaceIndex::needRebuild() const {
+  // small insert buffer is scanned linearly; rebalance, once tree has too many holes
+  if(dirty)
+    return true;
+  if(pending.size()>std::max(MinPending,index.size()/16))
+    return true;
+  return holes*4>index.size();
   }
 
 void BaseSpaceIndex::find(const Tempest::Vec3& p, float R, const void* ctx, void (*func)(const void*, Vob*)) {
-  if(index.size()==0)
+  if(needRebuild())
     buildIndex();
-  for(auto& i:dynamic)
-    (*func)(ctx,i);
+  for(auto i:dynamic)
+    (*func)(ctx,arr[i]);
+
+  const float qR = (R+500.f);
+  for(size_t i=0; i<pending.size(); ++i) {
+    auto v = arr[pending[i]];
+    if((v->position()-p).quadLength()<=qR*qR)
+      (*func)(ctx,v);
+    }
   implFind(index.data(),index.size(),0,p,R,ctx,func);
   }
 
 void BaseSpaceIndex::buildIndex() {
-  size_t cnt = 0;
-  index.resize(arr.size());
+  rebuilds++;
+  index.clear();
   dynamic.clear();
-  for(size_t i=0; i<arr.size(); ++i) {
+  pending.clear();
+  holes = 0;
+  dirty = false;
+
+  for(uint32_t i=0; i<arr.size(); ++i) {
     if(arr[i]->isDynamic()) {
-      dynamic.push_back(arr[i]);
+      slot[i] = Slot{L_Dynamic,uint32_t(dynamic.size())};
+      dynamic.push_back(i);
       } else {
-      index[cnt] = arr[i];
-      ++cnt;
+      index.push_back(Node{arr[i]->position(),i});
       }
     }
-  index.resize(cnt);
   buildIndex(index.data(),index.size(),0);
+  for(uint32_t i=0; i<index.size(); ++i)
+    slot[index[i].obj] = Slot{L_Index,i};
   }
 
-void BaseSpaceIndex::buildIndex(Vob** v, size_t cnt, uint8_t depth) {
+void BaseSpaceIndex::buildIndex(Node* v, size_t cnt, uint8_t depth) {
   depth%=3;
   sort(v,cnt,depth);
   size_t mid = cnt/2;
@@ -79,33 +166,33 @@ void BaseSpaceIndex::buildIndex(Vob** v, size_t cnt, uint8_t depth) {
     }
   }
 
-void BaseSpaceIndex::sort(Vob** v, size_t cnt, uint8_t component) {
-  bool (*predicate)(const Vob* a, const Vob* b) = nullptr;
+void BaseSpaceIndex::sort(Node* v, size_t cnt, uint8_t component) {
+  bool (*predicate)(const Node& a, const Node& b) = nullptr;
   switch(component) {
     case 0:
-      predicate = [](const Vob* a, const Vob* b){ return a->position().x < b->position().x; };
+      predicate = [](const Node& a, const Node& b){ return a.pos.x < b.pos.x; };
       break;
     case 1:
-      predicate = [](const Vob* a, const Vob* b){ return a->position().y < b->position().y; };
+      predicate = [](const Node& a, const Node& b){ return a.pos.y < b.pos.y; };
       break;
     case 2:
-      predicate = [](const Vob* a, const Vob* b){ return a->position().z < b->position().z; };
+      predicate = [](const Node& a, const Node& b){ return a.pos.z < b.pos.z; };
       break;
     }
   std::sort(v,v+cnt,predicate);
   }
 
-void BaseSpaceIndex::implFind(Vob** v, size_t cnt, uint8_t depth,
+void BaseSpaceIndex::implFind(const Node* v, size_t cnt, uint8_t depth,
                               const Tempest::Vec3& p, float R, const void* ctx, void (*func)(const void*, Vob*)) {
   if(cnt==0)
     return;
 
   auto mid = cnt/2;
-  auto pos = v[mid]->position();
+  auto pos = v[mid].pos;
   auto qR  = (R+500.0);//v[mid]->extendedSearchRadius());
 
-  if((pos-p).quadLength()<=qR*qR) {
-    func(ctx,v[mid]);
+  if(v[mid].obj!=NoObject && (pos-p).quadLength()<=qR*qR) {
+    func(ctx,arr[v[mid].obj]);
     }
 
   depth%=3;
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include <memory>
+#include <unordered_map>
 #include <Tempest/Point>
 
 #include "utils/workers.h"
@@ -13,15 +14,18 @@ class Vob;
 
 class BaseSpaceIndex {
   public:
-    void   clear();
-    size_t size() const { return arr.size(); }
-    void   invalidate();
+    void     clear();
+    size_t   size() const { return arr.size(); }
+    void     invalidate();
+    void     invalidate(const Vob* v);
+    uint64_t rebuildCount() const { return rebuilds; }
 
   protected:
     BaseSpaceIndex() = default;
     void               add(Vob* v);
     void               del(Vob* v);
     bool               hasObject(const Vob* v) const;
+    uint32_t           indexOf(const Vob* v) const;
 
     void               find(const Tempest::Vec3& p, float R, const void* ctx, void (*func)(const void*, Vob*));
     template<class Func>
@@ -30,14 +34,44 @@ class BaseSpaceIndex {
     Vob*const*         data() const { return arr.data(); }
 
   private:
+    enum Location : uint8_t {
+      L_Pending,
+      L_Index,
+      L_Dynamic,
+      };
+
+    struct Slot final {
+      Location loc = L_Pending;
+      uint32_t id  = 0;  // position in index, dynamic or pending
+      };
+
+    struct Node final {
+      Tempest::Vec3 pos;
+      uint32_t      obj = NoObject; // position in arr; NoObject - removed, left in tree until rebuild
+      };
+
+    static constexpr uint32_t NoObject   = uint32_t(-1);
+    static constexpr size_t   MinPending = 32;
+
     std::vector<Vob*>  arr;
-    std::vector<Vob*>  index;
-    std::vector<Vob*>  dynamic;
+    std::vector<Slot>  slot;     // parallel to arr
+    std::unordered_map<const Vob*,uint32_t> lookup;
+
+    std::vector<Node>     index;
+    std::vector<uint32_t> dynamic;
+    std::vector<uint32_t> pending; // added or moved since last rebuild, not sorted
+    size_t                holes    = 0;
+    bool                  dirty    = true;
+    uint64_t              rebuilds = 0;
+
+    bool               needRebuild() const;
+    void               detach(uint32_t id);
+    void               relink(uint32_t id);
 
     void               buildIndex();
-    void               buildIndex(Vob** v, size_t cnt, uint8_t depth);
-    void               sort(Vob** v, size_t cnt, uint8_t component);
-    void               implFind(Vob** v, size_t cnt, uint8_t depth, const Tempest::Vec3& p, float R, const void* ctx, void(*func)(const void*, Vob*));
+    void               buildIndex(Node* v, size_t cnt, uint8_t depth);
+    void               sort(Node* v, size_t cnt, uint8_t component);
+    void               implFind(const Node* v, size_t cnt, uint8_t depth, const Tempest::Vec3& p, float R, const void* ctx, void(*func)(const void*, Vob*));
   };
 
 template<class Func>
@@ -63,6 +97,11 @@ class SpaceIndex final : public BaseSpaceIndex {
       return BaseSpaceIndex::hasObject(v);
       }
 
+    // position in iteration order, or uint32_t(-1)
+    uint32_t indexOf(const T* v) const {
+      return BaseSpaceIndex::indexOf(v);
+      }
+
     T**       begin()        { return reinterpret_cast<T**>(data()); }
     T**       end()          { return begin()+size();                }
 
@@ -3,6 +3,8 @@
 #include <Tempest/Log>
 #include <algorithm>
 #include <limits>
+#include <cmath>
+#include <cstdio>
 
 #include "game/movealgo.h"
 #include "utils/gthfont.h"
@@ -12,6 +14,13 @@
 
 using namespace Tempest;
 
+static bool isLinked(const WayPoint& from, const WayPoint& to) {
+  for(auto& c:from.connections())
+    if(c.point==&to)
+      return true;
+  return false;
+  }
+
 WayMatrix::WayMatrix(World &world, const phoenix::way_net &dat)
   :world(world) {
   // scripting doc says 20m, but number seems to be incorrect
@@ -36,11 +45,11 @@ WayMatrix::WayMatrix(World &world, const phoenix::way_net &dat)
     if(i.name.find("START")!=std::string::npos)
       startPoints.push_back(i);
 
-  stk[0].reserve(256);
-  stk[1].reserve(256);
+  heap.reserve(256);
   }
 
 void WayMatrix::buildIndex() {
+  invalidateRoutes();
   indexPoints.clear();
   adjustWaypoints(wayPoints);
   adjustWaypoints(freePoints);
@@ -49,11 +58,14 @@ void WayMatrix::buildIndex() {
     return a->name<b->name;
     });
 
+  // start points take precedence over way and free points of the same name
+  pointsByName.clear();
+  for(auto& i:startPoints)
+    pointsByName.insert(i.name,&i);
+  for(auto& i:wayPoints)
+    pointsByName.insert(i.name,&i);
   for(auto& i:freePoints)
-    fpInd.push_back(&i);
-  std::sort(fpInd.begin(),fpInd.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->x<b->x;
-    });
+    pointsByName.insert(i.name,&i);
 
   for(auto& i:edges){
     if(i.a<wayPoints.size() && i.b<wayPoints.size()){
@@ -64,6 +76,7 @@ void WayMatrix::buildIndex() {
       b.connect(a);
       }
     }
+  buildClusters();
   }
 
 const WayPoint *WayMatrix::findWayPoint(const Vec3& at, const Vec3& to, const std::function<bool(const WayPoint&)>& filter) const {
@@ -87,11 +100,6 @@ const WayPoint *WayMatrix::findWayPoint(const Vec3& at, const Vec3& to, const st
   return ret;
   }
 
-const WayPoint *WayMatrix::findFreePoint(const Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const {
-  auto&  index = findFpIndex(name);
-  return findFreePoint(at.x,at.y,at.z,index,filter);
-  }
-
 const WayPoint *WayMatrix::findNextPoint(const Vec3& at) const {
   const WayPoint* ret   = nullptr;
   float           dist  = distanceThreshold;
@@ -111,10 +119,12 @@ const WayPoint *WayMatrix::findNextPoint(const Vec3& at) const {
   }
 
 void WayMatrix::addFreePoint(const Vec3& pos, const Vec3& dir, std::string_view name) {
+  invalidateRoutes();
   freePoints.emplace_back(pos,dir,name);
   }
 
 void WayMatrix::addStartPoint(const Vec3& pos, const Vec3& dir, std::string_view name) {
+  invalidateRoutes();
   startPoints.emplace_back(pos,dir,name);
   }
 
@@ -134,9 +144,8 @@ const WayPoint &WayMatrix::startPoint() const {
   }
 
 const WayPoint& WayMatrix::deadPoint() const {
-  for(auto& i:indexPoints)
-    if(i->name=="TOT")
-      return *i;
+  if(auto p = pointsByName.find("TOT"))
+    return *p;
   static WayPoint p(Vec3(-1000,-1000,-1000),"TOT");
   return p;
   }
@@ -144,14 +153,8 @@ const WayPoint& WayMatrix::deadPoint() const {
 const WayPoint* WayMatrix::findPoint(std::string_view name, bool inexact) const {
   if(name.empty())
     return nullptr;
-  for(auto& i:startPoints)
-    if(name==i.name)
-      return &i;
-  auto it = std::lower_bound(indexPoints.begin(),indexPoints.end(),name,[](const WayPoint* a, std::string_view b){
-      return a->name<b;
-    });
-  if(it!=indexPoints.end() && name==(*it)->name)
-    return *it;
+  if(auto p = pointsByName.find(name))
+    return p;
   if(!inexact)
     return nullptr;
   for(auto i:indexPoints)
@@ -199,47 +202,63 @@ const WayMatrix::FpIndex &WayMatrix::findFpIndex(std::string_view name) const {
 
   FpIndex id;
   id.key = name;
+  std::vector<std::pair<uint64_t,const WayPoint*>> pt;
   for(auto& w:freePoints){
     if(!w.checkName(name))
       continue;
-    id.index.push_back(&w);
+    pt.emplace_back(fpCell(fpCellId(w.x),fpCellId(w.y),fpCellId(w.z)),&w);
     }
-  // TODO: good index, not sort by 'x' :)
-  std::sort(id.index.begin(),id.index.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->x<b->x;
+  std::stable_sort(pt.begin(),pt.end(),[](const std::pair<uint64_t,const WayPoint*>& a, const std::pair<uint64_t,const WayPoint*>& b){
+    return a.first<b.first;
     });
 
+  id.index.resize(pt.size());
+  for(size_t i=0; i<pt.size(); ++i) {
+    id.index[i] = pt[i].second;
+    auto& c = id.cells[pt[i].first];
+    if(c.second==0)
+      c.first = uint32_t(i);
+    c.second++;
+    }
+
   it = fpIndex.insert(it,std::move(id));
   return *it;
   }
 
-const WayPoint *WayMatrix::findFreePoint(float x, float y, float z, const FpIndex& ind,
-                                         const std::function<bool(const WayPoint&)>& filter) const {
-  float R = distanceThreshold;
-  auto b = std::lower_bound(ind.index.begin(),ind.index.end(), x-R ,[](const WayPoint *a, float b){
-    return a->x<b;
-    });
-  auto e = std::upper_bound(ind.index.begin(),ind.index.end(), x+R ,[](float a,const WayPoint *b){
-    return a<b->x;
-    });
+void WayMatrix::fpCandidates(const Vec3& at, const FpIndex& ind) const {
+  const float R = distanceThreshold;
+  fpHeap.clear();
+  if(ind.index.empty())
+    return;
 
-  const WayPoint* ret=nullptr;
-  auto  count = std::distance(b,e);(void) count;
-  float dist  = R*R;
-  for(auto i=b;i!=e;++i){
-    auto& w  = **i;
-    float dx = w.x-x;
-    float dy = w.y-y;
-    float dz = w.z-z;
-    float l  = dx*dx+dy*dy+dz*dz;
-    if(l>dist || dz*dz>300*300)
-      continue;
-    if(!filter(w))
-      continue;
-    ret  = &w;
-    dist = l;
-    }
-  return ret;
+  const int32_t x0 = fpCellId(at.x-R), x1 = fpCellId(at.x+R);
+  const int32_t y0 = fpCellId(at.y-R), y1 = fpCellId(at.y+R);
+  const int32_t z0 = fpCellId(at.z-R), z1 = fpCellId(at.z+R);
+  for(int32_t x=x0; x<=x1; ++x)
+    for(int32_t y=y0; y<=y1; ++y)
+      for(int32_t z=z0; z<=z1; ++z) {
+        auto c = ind.cells.find(fpCell(x,y,z));
+        if(c==ind.cells.end())
+          continue;
+        for(uint32_t i=c->second.first; i<c->second.first+c->second.second; ++i) {
+          auto& w  = *ind.index[i];
+          float dx = w.x-at.x;
+          float dy = w.y-at.y;
+          float dz = w.z-at.z;
+          float l  = dx*dx+dy*dy+dz*dz;
+          if(l>R*R || dz*dz>300*300)
+            continue;
+          fpHeap.emplace_back(l,&w);
+          }
+        }
+  std::make_heap(fpHeap.begin(),fpHeap.end(),std::greater<>());
+  }
+
+uint64_t WayMatrix::fpCell(int32_t x, int32_t y, int32_t z) {
+  // 21 bit per axis; with 40m cells it covers +-40000km
+  return  (uint64_t(uint32_t(x) & 0x1FFFFF)<<42) |
+          (uint64_t(uint32_t(y) & 0x1FFFFF)<<21) |
+          (uint64_t(uint32_t(z) & 0x1FFFFF));
   }
 
 WayPath WayMatrix::wayTo(const WayPoint& begin, const WayPoint& end) const {
@@ -253,57 +272,329 @@ WayPath WayMatrix::wayTo(const WayPoint& begin, const WayPoint& end) const {
     return WayPath();
     }
 
-  pathGen++;
-  if(pathGen==1){
-    // new cycle
-    for(auto& i:wayPoints)
-      i.pathGen=0;
+  const RouteKey key = {&begin,&end};
+  if(auto it = routeCache.find(key); it!=routeCache.end()) {
+    routeHit++;
+    routeLru.splice(routeLru.begin(),routeLru,it->second);
+    return it->second->path;
     }
-  begin.pathLen = 0;
-  begin.pathGen = pathGen;
-
-  std::vector<const WayPoint*> *front=&stk[0], *back=&stk[1];
-  stk[0].clear();
-  stk[1].clear();
-
-  front->push_back(&begin);
-
-  while(end.pathGen!=pathGen && front->size()>0){
-    for(auto& wp:*front){
-      int32_t l0 = wp->pathLen;
-
-      for(auto i:wp->connections()){
-        auto& w  = *i.point;
-        int32_t l1 = l0+i.len;
-        if(w.pathGen!=pathGen || w.pathLen>l1){
-          w.pathLen = l1;
-          w.pathGen = pathGen;
-          back->push_back(&w);
-          }
-        }
+  routeMiss++;
+
+  WayPath ret = findPath(begin,end);
+  if(routeLru.size()>=routeCacheSize) {
+    routeCache.erase(routeLru.back().key);
+    routeLru.pop_back();
+    }
+  routeLru.push_front(Route{key,ret});
+  routeCache[key] = routeLru.begin();
+  return ret;
+  }
+
+void WayMatrix::invalidateRoutes() {
+  routeLru.clear();
+  routeCache.clear();
+  }
+
+void WayMatrix::dumpStats(const std::function<void(std::string_view)>& out) const {
+  char buf[256] = {};
+  const uint64_t total = routeHit+routeMiss;
+  std::snprintf(buf,sizeof(buf),"waynet: %d points, route cache %d/%d, hit: %llu, miss: %llu (%.1f%%), expanded: %llu",
+                int(wayPoints.size()),int(routeLru.size()),int(routeCacheSize),
+                static_cast<unsigned long long>(routeHit),static_cast<unsigned long long>(routeMiss),
+                total==0 ? 0.0 : double(routeHit*100)/double(total),
+                static_cast<unsigned long long>(expanded));
+  out(buf);
+  std::snprintf(buf,sizeof(buf),"  clusters: %d, portals: %d, hierarchical queries: %llu",
+                int(clusterPortals.size()),int(portals.size()),static_cast<unsigned long long>(hierarchical));
+  out(buf);
+  std::snprintf(buf,sizeof(buf),"  free points: %d, names indexed: %d, queries: %llu, filter calls: %llu",
+                int(freePoints.size()),int(fpIndex.size()),
+                static_cast<unsigned long long>(fpQueries),static_cast<unsigned long long>(fpTested));
+  out(buf);
+  }
+
+WayPath WayMatrix::findPath(const WayPoint& begin, const WayPoint& end) const {
+  const float dist = (end.position()-begin.position()).quadLength();
+  if(!portals.empty() && dist>hierarchyDistance*hierarchyDistance) {
+    const uint32_t cb = clusterOf(begin);
+    const uint32_t ce = clusterOf(end);
+    if(cb!=NoCluster && ce!=NoCluster && cb!=ce)
+      return findPathHierarchical(begin,end);
+    }
+  return findPathFlat(begin,end);
+  }
+
+WayPath WayMatrix::findPathFlat(const WayPoint& begin, const WayPoint& end) const {
+  if(!search(begin,&end,NoCluster))
+    return WayPath();
+
+  WayPath ret;
+  for(auto i=&end; i!=nullptr; i=i->pathParent)
+    ret.add(*i);
+  return ret;
+  }
+
+WayPath WayMatrix::findPathHierarchical(const WayPoint& begin, const WayPoint& end) const {
+  hierarchical++;
+  portalGen++;
+  if(portalGen==0) {
+    for(auto& p:portals)
+      p.pathGen = p.endGen = 0;
+    portalGen = 1;
+    }
+
+  // distances from begin/end to portals of own cluster
+  const uint32_t cb = clusterOf(begin);
+  const uint32_t ce = clusterOf(end);
+  search(end,nullptr,ce);
+  for(auto id:clusterPortals[ce]) {
+    auto& p = portals[id];
+    if(p.point->pathGen==pathGen) {
+      p.endLen = p.point->pathLen;
+      p.endGen = portalGen;
+      }
+    }
+
+  // A* over portals; queue with lazy deletion
+  const Vec3 dst     = end.position();
+  float      goalLen = std::numeric_limits<float>::max();
+  uint32_t   goalPrt = NoCluster;
+  auto relax = [&](uint32_t id, uint32_t from, float l) {
+    auto& p = portals[id];
+    if(p.pathGen==portalGen && p.pathLen<=l)
+      return;
+    p.pathLen    = l;
+    p.pathParent = from;
+    p.pathGen    = portalGen;
+    portalHeap.push_back({l+(p.point->position()-dst).length(),id});
+    std::push_heap(portalHeap.begin(),portalHeap.end(),std::greater<>());
+    };
+
+  portalHeap.clear();
+  search(begin,nullptr,cb);
+  for(auto id:clusterPortals[cb]) {
+    auto& w = *portals[id].point;
+    if(w.pathGen==pathGen)
+      relax(id,NoCluster,w.pathLen);
+    }
+
+  while(!portalHeap.empty() && portalHeap[0].first<goalLen) {
+    std::pop_heap(portalHeap.begin(),portalHeap.end(),std::greater<>());
+    auto [est,id] = portalHeap.back();
+    portalHeap.pop_back();
+
+    auto& p = portals[id];
+    if(est>p.pathLen+(p.point->position()-dst).length())
+      continue; // stale entry
+    expanded++;
+
+    if(p.endGen==portalGen && p.pathLen+p.endLen<goalLen) {
+      goalLen = p.pathLen+p.endLen;
+      goalPrt = id;
       }
-    std::swap(front,back);
-    back->clear();
+    for(auto& e:p.edges)
+      relax(e.to,id,p.pathLen+e.len);
     }
 
+  if(goalPrt==NoCluster)
+    return WayPath();
+
+  // refine: each step is either a border edge or a path inside of one cluster
   WayPath ret;
   ret.add(end);
-  const WayPoint* current = &end;
-  while(current!=&begin) {
-    int32_t l0 = current->pathLen, l1=l0;
-
-    const WayPoint* next=nullptr;
-    for(auto i:current->connections()){
-      if(i.point->pathGen==pathGen && i.point->pathLen+i.len<=l0 && i.point->pathLen<l1){
-        next = i.point;
-        l1   = i.point->pathLen;
+  const WayPoint* at = &end;
+  for(uint32_t id=goalPrt; ; id=portals[id].pathParent) {
+    const WayPoint& next = id==NoCluster ? begin : *portals[id].point;
+    const uint32_t  c    = clusterOf(next);
+    if(at!=&next) {
+      // no straight-line jumps: if refinement fails, path is searched over whole graph
+      if(c!=clusterOf(*at)) {
+        if(!isLinked(next,*at))
+          return findPathFlat(begin,end);
+        ret.add(next);
+        } else {
+        if(!search(next,at,c))
+          return findPathFlat(begin,end);
+        for(auto w=at->pathParent; w!=nullptr; w=w->pathParent)
+          ret.add(*w);
         }
+      at = &next;
       }
-    if(next==nullptr)
-      return WayPath();
-    ret.add(*next);
-    current=next;
+    if(id==NoCluster)
+      break;
     }
+  return ret;
+  }
 
+bool WayMatrix::search(const WayPoint& begin, const WayPoint* end, uint32_t cluster) const {
+  pathGen++;
+  if(pathGen==0) {
+    // wrap-around: generation 0 is 'never visited'; heapId of aborted searches is stale as well
+    for(auto* v:{&wayPoints,&freePoints,&startPoints})
+      for(auto& i:*v) {
+        i.pathGen = 0;
+        i.heapId  = uint32_t(-1);
+        }
+    pathGen = 1;
+    }
+
+  // A*: edge length is euclidean distance, so straight line to the target is consistent heuristic
+  // without target it is a plain Dijkstra over whole cluster
+  const Vec3 dst = end!=nullptr ? end->position() : Vec3();
+  auto heuristic = [end,dst](const WayPoint& w) {
+    return end!=nullptr ? (w.position()-dst).length() : 0.f;
+    };
+  heap.clear();
+
+  begin.pathLen    = 0;
+  begin.pathEst    = heuristic(begin);
+  begin.pathParent = nullptr;
+  begin.pathGen    = pathGen;
+  heapPush(begin);
+
+  while(!heap.empty()) {
+    auto& wp = *heapPop();
+    expanded++;
+    if(&wp==end)
+      return true;
+
+    for(auto& i:wp.connections()) {
+      auto& w  = *i.point;
+      if(cluster!=NoCluster && clusterOf(w)!=cluster)
+        continue;
+      float l1 = wp.pathLen+i.len;
+      if(w.pathGen!=pathGen) {
+        w.pathLen    = l1;
+        w.pathEst    = l1+heuristic(w);
+        w.pathParent = &wp;
+        w.pathGen    = pathGen;
+        heapPush(w);
+        }
+      else if(w.heapId!=uint32_t(-1) && l1<w.pathLen) {
+        // decrease-key; heuristic part is kept
+        w.pathEst    = l1+(w.pathEst-w.pathLen);
+        w.pathLen    = l1;
+        w.pathParent = &wp;
+        heapUp(w.heapId);
+        }
+      }
+    }
+  return end==nullptr;
+  }
+
+uint32_t WayMatrix::clusterOf(const WayPoint& w) const {
+  // free- and start-points are not part of any cluster
+  const WayPoint* b = wayPoints.data();
+  if(&w<b || &w>=b+wpCluster.size())
+    return NoCluster;
+  return wpCluster[size_t(&w-b)];
+  }
+
+void WayMatrix::buildClusters() {
+  wpCluster.assign(wayPoints.size(),NoCluster);
+  clusterPortals.clear();
+  portals.clear();
+
+  // partition by uniform grid in xz-plane
+  std::unordered_map<uint64_t,uint32_t> cells;
+  for(size_t i=0; i<wayPoints.size(); ++i) {
+    auto&    w   = wayPoints[i];
+    auto     cx  = int32_t(std::floor(w.x/clusterSize));
+    auto     cz  = int32_t(std::floor(w.z/clusterSize));
+    uint64_t key = (uint64_t(uint32_t(cx))<<32) | uint64_t(uint32_t(cz));
+    wpCluster[i] = cells.emplace(key,uint32_t(cells.size())).first->second;
+    }
+  clusterPortals.resize(cells.size());
+
+  // portal: waypoint with an edge into another cluster
+  std::vector<uint32_t> wpPortal(wayPoints.size(),NoCluster);
+  for(size_t i=0; i<wayPoints.size(); ++i) {
+    for(auto& c:wayPoints[i].connections()) {
+      const uint32_t cl = clusterOf(*c.point);
+      if(cl==wpCluster[i] || cl==NoCluster)
+        continue;
+      Portal p;
+      p.point     = &wayPoints[i];
+      p.cluster   = wpCluster[i];
+      wpPortal[i] = uint32_t(portals.size());
+      clusterPortals[p.cluster].push_back(wpPortal[i]);
+      portals.push_back(std::move(p));
+      break;
+      }
+    }
+
+  for(auto& p:portals) {
+    for(auto& c:p.point->connections()) {
+      const uint32_t cl = clusterOf(*c.point);
+      if(cl==p.cluster || cl==NoCluster)
+        continue;
+      p.edges.push_back({wpPortal[size_t(c.point-wayPoints.data())],c.len});
+      }
+    }
+
+  // intra-cluster distances between portals
+  for(auto& cl:clusterPortals) {
+    for(auto pa:cl) {
+      auto& a = portals[pa];
+      search(*a.point,nullptr,a.cluster);
+      for(auto pb:cl) {
+        auto& b = *portals[pb].point;
+        if(pa!=pb && b.pathGen==pathGen)
+          a.edges.push_back({pb,b.pathLen});
+        }
+      }
+    }
+  }
+
+void WayMatrix::heapPush(const WayPoint& w) const {
+  w.heapId = uint32_t(heap.size());
+  heap.push_back(&w);
+  heapUp(w.heapId);
+  }
+
+const WayPoint* WayMatrix::heapPop() const {
+  auto ret = heap[0];
+  ret->heapId = uint32_t(-1);
+  if(heap.size()>1) {
+    heap[0]         = heap.back();
+    heap[0]->heapId = 0;
+    heap.pop_back();
+    heapDown(0);
+    } else {
+    heap.pop_back();
+    }
   return ret;
   }
+
+void WayMatrix::heapUp(uint32_t id) const {
+  auto w = heap[id];
+  while(id>0) {
+    uint32_t parent = (id-1)/2;
+    if(heap[parent]->pathEst<=w->pathEst)
+      break;
+    heap[id]         = heap[parent];
+    heap[id]->heapId = id;
+    id = parent;
+    }
+  heap[id]  = w;
+  w->heapId = id;
+  }
+
+void WayMatrix::heapDown(uint32_t id) const {
+  auto           w  = heap[id];
+  const uint32_t sz = uint32_t(heap.size());
+  while(true) {
+    uint32_t child = id*2+1;
+    if(child>=sz)
+      break;
+    if(child+1<sz && heap[child+1]->pathEst<heap[child]->pathEst)
+      child++;
+    if(w->pathEst<=heap[child]->pathEst)
+      break;
+    heap[id]         = heap[child];
+    heap[id]->heapId = id;
+    id = child;
+    }
+  heap[id]  = w;
+  w->heapId = id;
+  }
@@ -7,9 +7,14 @@
 
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <unordered_map>
 
 #include "waypath.h"
 #include "waypoint.h"
+#include "nameindex.h"
 
 class World;
 class DbgPainter;
@@ -19,7 +24,8 @@ class WayMatrix final {
     WayMatrix(World& owner,const phoenix::way_net& dat);
 
     const WayPoint* findWayPoint (const Tempest::Vec3& at, const Tempest::Vec3& to, const std::function<bool(const WayPoint&)>& filter) const;
-    const WayPoint* findFreePoint(const Tempest::Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const;
+    template<class F>
+    const WayPoint* findFreePoint(const Tempest::Vec3& at, std::string_view name, const F& filter) const;
     const WayPoint* findNextPoint(const Tempest::Vec3& at) const;
 
     void            addFreePoint (const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
@@ -33,6 +39,8 @@ class WayMatrix final {
     void            marchPoints(DbgPainter& p) const;
 
     WayPath         wayTo(const WayPoint &begin, const WayPoint& end) const;
+    uint64_t        expandedNodes() const { return expanded; }
+    void            dumpStats(const std::function<void(std::string_view)>& out) const;
 
   private:
     World&                 world;
@@ -40,24 +48,110 @@ class WayMatrix final {
 
     std::vector<phoenix::way_edge> edges;
 
-    std::vector<WayPoint>  wayPoints;
-    std::vector<WayPoint>  freePoints, startPoints;
-    std::vector<WayPoint*> indexPoints;
-
-    std::vector<WayPoint*> fpInd;
+    std::vector<WayPoint>     wayPoints;
+    std::vector<WayPoint>     freePoints, startPoints;
+    std::vector<WayPoint*>    indexPoints;
+    NameIndex<const WayPoint> pointsByName;
 
+    // free points of one name, bucketed by 3d-grid cells of 2*distanceThreshold size:
+    // query of radius distanceThreshold spans at most 2x2x2 cells
     struct FpIndex {
       std::string                  key;
       std::vector<const WayPoint*> index;
+      std::unordered_map<uint64_t,std::pair<uint32_t,uint32_t>> cells;
       };
     mutable std::vector<FpIndex>          fpIndex;
-
-    mutable uint16_t                      pathGen=0;
-    mutable std::vector<const WayPoint*>  stk[2];
+    mutable std::vector<std::pair<float,const WayPoint*>> fpHeap;
+    mutable uint64_t                      fpQueries=0;
+    mutable uint64_t                      fpTested=0;
+
+    mutable uint32_t                      pathGen=0;
+    mutable std::vector<const WayPoint*>  heap;
+    mutable uint64_t                      expanded=0;
+
+    // LRU cache of waynet routes; cleared, whenever graph is changed
+    struct RouteKey final {
+      const WayPoint* begin = nullptr;
+      const WayPoint* end   = nullptr;
+      bool operator == (const RouteKey& other) const { return begin==other.begin && end==other.end; }
+      };
+    struct RouteHash final {
+      size_t operator()(const RouteKey& k) const {
+        return std::hash<const void*>()(k.begin) ^ (std::hash<const void*>()(k.end)*31);
+        }
+      };
+    struct Route final {
+      RouteKey key;
+      WayPath  path;
+      };
+    static constexpr size_t               routeCacheSize = 1024;
+    mutable std::list<Route>              routeLru;
+    mutable std::unordered_map<RouteKey,std::list<Route>::iterator,RouteHash> routeCache;
+    mutable uint64_t                      routeHit=0;
+    mutable uint64_t                      routeMiss=0;
+
+    // hierarchical layer: grid clusters, connected through border waypoints (portals);
+    // portal edges are either border edges or exact shortest distances inside of cluster
+    static constexpr uint32_t             NoCluster         = uint32_t(-1);
+    static constexpr float                clusterSize       = 40.f*100.f;
+    static constexpr float                hierarchyDistance = 100.f*100.f;
+    struct PortalEdge final {
+      uint32_t to  = 0;
+      float    len = 0;
+      };
+    struct Portal final {
+      const WayPoint*         point   = nullptr;
+      uint32_t                cluster = 0;
+      std::vector<PortalEdge> edges;
+
+      // search state, same as in WayPoint
+      mutable float           pathLen    = 0;
+      mutable float           endLen     = 0;
+      mutable uint32_t        pathParent = 0;
+      mutable uint32_t        pathGen    = 0;
+      mutable uint32_t        endGen     = 0;
+      };
+    std::vector<uint32_t>                 wpCluster;
+    std::vector<std::vector<uint32_t>>    clusterPortals;
+    std::vector<Portal>                   portals;
+    mutable uint32_t                      portalGen=0;
+    mutable std::vector<std::pair<float,uint32_t>> portalHeap;
+    mutable uint64_t                      hierarchical=0;
 
     void                   adjustWaypoints(std::vector<WayPoint> &wp);
 
+    WayPath                findPath(const WayPoint& begin, const WayPoint& end) const;
+    WayPath                findPathHierarchical(const WayPoint& begin, const WayPoint& end) const;
+    WayPath                findPathFlat(const WayPoint& begin, const WayPoint& end) const;
+    bool                   search(const WayPoint& begin, const WayPoint* end, uint32_t cluster) const;
+    uint32_t               clusterOf(const WayPoint& w) const;
+    void                   buildClusters();
+    void                   invalidateRoutes();
+
+    void                   heapPush(const WayPoint& w) const;
+    const WayPoint*        heapPop() const;
+    void                   heapUp  (uint32_t id) const;
+    void                   heapDown(uint32_t id) const;
+
     const FpIndex&         findFpIndex(std::string_view name) const;
-    const WayPoint*        findFreePoint(float x, float y, float z, const FpIndex &ind,
-                                         const std::function<bool(const WayPoint&)>& filter) const;
+    void                   fpCandidates(const Tempest::Vec3& at, const FpIndex& ind) const;
+    static uint64_t        fpCell(int32_t x, int32_t y, int32_t z);
+    int32_t                fpCellId(float v) const { return int32_t(std::floor(v/(2.f*distanceThreshold))); }
   };
+
+template<class F>
+const WayPoint* WayMatrix::findFreePoint(const Tempest::Vec3& at, std::string_view name, const F& filter) const {
+  // nearest-first: filter is evaluated only, until first match
+  auto& ind = findFpIndex(name);
+  fpCandidates(at,ind);
+  fpQueries++;
+  while(!fpHeap.empty()) {
+    std::pop_heap(fpHeap.begin(),fpHeap.end(),std::greater<>());
+    auto w = fpHeap.back().second;
+    fpHeap.pop_back();
+    fpTested++;
+    if(filter(*w))
+      return w;
+    }
+  return nullptr;
+  }
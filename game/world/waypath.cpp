@@ -9,33 +9,47 @@ WayPath::WayPath() {
 void WayPath::load(Serialize &fin) {
   uint32_t sz=0;
   fin.read(sz);
-  dat.resize(sz);
+  dat  = std::make_shared<Storage>(sz);
+  size = sz;
 
-  for(auto& i:dat)
+  for(auto& i:*dat)
     fin.read(i);
   }
 
 void WayPath::save(Serialize &fout) {
-  fout.write(uint32_t(dat.size()));
+  fout.write(uint32_t(size));
 
-  for(auto& i:dat)
-    fout.write(i);
+  for(size_t i=0; i<size; ++i)
+    fout.write((*dat)[i]);
+  }
+
+void WayPath::add(const WayPoint& p) {
+  if(dat==nullptr || dat.use_count()>1) {
+    // copy on write
+    auto d = std::make_shared<Storage>();
+    if(dat!=nullptr)
+      d->assign(dat->begin(),dat->begin()+intptr_t(size));
+    dat = std::move(d);
+    }
+  dat->resize(size);
+  dat->push_back(&p);
+  size++;
   }
 
 void WayPath::clear() {
-  dat.clear();
+  dat  = nullptr;
+  size = 0;
   }
 
 const WayPoint *WayPath::pop() {
-  if(dat.size()==0)
+  if(size==0)
     return nullptr;
-  auto ret = dat[dat.size()-1];
-  dat.pop_back();
-  return ret;
+  size--;
+  return (*dat)[size];
   }
 
 const WayPoint *WayPath::last() const {
-  if(dat.size()==0)
+  if(size==0)
     return nullptr;
-  return dat[0];
+  return (*dat)[0];
   }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 class WayPoint;
@@ -7,17 +8,21 @@ class Serialize;
 
 class WayPath final {
   public:
+    using Storage = std::vector<const WayPoint*>;
+
     WayPath();
 
     void load(Serialize& fin);
     void save(Serialize& fout);
 
-    void add(const WayPoint& p){ dat.push_back(&p); }
+    void add(const WayPoint& p);
     void clear();
 
     const WayPoint* pop();
     const WayPoint* last() const;
 
   private:
-    std::vector<const WayPoint*> dat;
+    // storage is shared between copies of same route (see WayMatrix route-cache) and never modified, once shared
+    std::shared_ptr<Storage> dat;
+    size_t                   size = 0;
   };
@@ -61,8 +61,8 @@ float WayPoint::qDistTo(float ix, float iy, float iz) const {
   }
 
 void WayPoint::connect(WayPoint &w) {
-  int32_t l = int32_t(std::sqrt(qDistTo(w.x,w.y,w.z)));
-  if(l<=0)
+  float l = std::sqrt(qDistTo(w.x,w.y,w.z));
+  if(l<1.f)
     return;
   Conn c;
   c.point = &w;
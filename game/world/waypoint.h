@@ -37,12 +37,16 @@ class WayPoint final {
 
     struct Conn final {
       WayPoint* point=nullptr;
-      int32_t   len  =0;
+      float     len  =0;
       };
 
     // TODO: beautify
-    mutable int32_t  pathLen=std::numeric_limits<int32_t>::max();
-    mutable uint16_t pathGen=0;
+    // A* state, owned by WayMatrix::wayTo; valid only if pathGen matches current search
+    mutable float           pathLen    = 0;
+    mutable float           pathEst    = 0;
+    mutable const WayPoint* pathParent = nullptr;
+    mutable uint32_t        heapId     = uint32_t(-1);
+    mutable uint32_t        pathGen    = 0;
 
     float qDistTo(float x,float y,float z) const;
 
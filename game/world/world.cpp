@@ -18,6 +18,7 @@
 #include "gothic.h"
 #include "focus.h"
 #include "resources.h"
+#include "utils/profiler.h"
 
 const char* materialTag(ItemMaterial src) {
   switch(src) {
@@ -76,10 +77,10 @@ World::World(GameSession& game, std::string_view file, bool startup, std::functi
     loadProgress(20);
 
     auto& worldMesh = world.world_mesh;
-    {
+    if(!Gothic::inst().isHeadless()) {
       PackedMesh vmesh(worldMesh,PackedMesh::PK_VisualLnd);
       wview.reset   (new WorldView(*this,vmesh));
-    }
+      }
 
     loadProgress(50);
     wdynamic.reset(new DynamicWorld(*this,worldMesh));
@@ -95,6 +96,7 @@ World::World(GameSession& game, std::string_view file, bool startup, std::functi
     wmatrix->buildIndex();
     bsp = std::move(world.world_bsp_tree);
     bspSectors.resize(bsp.sectors.size());
+    buildBspIndex();
     loadProgress(100);
     }
   catch(...) {
@@ -233,30 +235,44 @@ MeshObjects::Mesh World::addView(std::string_view visual) const {
   }
 
 MeshObjects::Mesh World::addView(std::string_view visual, int32_t headTex, int32_t teetTex, int32_t bodyColor) const {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addView(visual,headTex,teetTex,bodyColor);
   }
 
 MeshObjects::Mesh World::addView(const phoenix::c_item& itm) {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addView(itm.visual,itm.material,0,itm.material);
   }
 
 MeshObjects::Mesh World::addView(const ProtoMesh* visual) {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addView(visual);
   }
 
 MeshObjects::Mesh World::addAtachView(const ProtoMesh::Attach& visual, const int32_t version) {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addAtachView(visual,version);
   }
 
 MeshObjects::Mesh World::addStaticView(const ProtoMesh* visual, bool staticDraw) {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addStaticView(visual,staticDraw);
   }
 
 MeshObjects::Mesh World::addStaticView(std::string_view visual) {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addStaticView(visual);
   }
 
 MeshObjects::Mesh World::addDecalView(const phoenix::vob& vob) {
+  if(wview==nullptr)
+    return MeshObjects::Mesh();
   return view()->addDecalView(vob);
   }
 
@@ -277,63 +293,81 @@ Npc *World::findNpcByInstance(size_t instance) {
   }
 
 std::string_view World::roomAt(const Tempest::Vec3& p) {
-  if(bsp.nodes.empty())
+  uint32_t leaf = NoBspNode;
+  return roomAt(p,leaf);
+  }
+
+std::string_view World::roomAt(const Tempest::Vec3& p, uint32_t& leaf) {
+  if(leaf>=bsp.nodes.size() || !isInside(bsp.nodes[leaf],p)) {
+    leaf = bspLeafAt(p);
+    if(leaf==NoBspNode)
+      return "";
+    }
+  const uint32_t sector = bspLeafSector[leaf];
+  if(sector==NoBspNode)
     return "";
+  return bsp.sectors[sector].name;
+  }
 
-  const auto* node=&bsp.nodes[0];
+uint32_t World::bspLeafAt(const Tempest::Vec3& p) const {
+  if(bsp.nodes.empty())
+    return NoBspNode;
 
+  uint32_t id = 0;
   while(true) {
-    const auto v    = node->plane;
-    float        sgn  = v.x*p.x + v.y*p.y + v.z*p.z - v.w;
-    uint32_t     next = (sgn>0) ? node->front_index : node->back_index;
+    const auto  v    = bsp.nodes[id].plane;
+    float       sgn  = v.x*p.x + v.y*p.y + v.z*p.z - v.w;
+    uint32_t    next = (sgn>0) ? bsp.nodes[id].front_index : bsp.nodes[id].back_index;
     if(next>=bsp.nodes.size())
       break;
-
-    node = &bsp.nodes[next];
+    id = next;
     }
 
-  if(node->bbox.min.x <= p.x && p.x <node->bbox.max.x &&
-     node->bbox.min.y <= p.y && p.y <node->bbox.max.y &&
-     node->bbox.min.z <= p.z && p.z <node->bbox.max.z) {
-    return roomAt(*node);
-    }
-
-  return "";
+  if(isInside(bsp.nodes[id],p))
+    return id;
+  return NoBspNode;
   }
 
-std::string_view World::roomAt(const phoenix::bsp_node& node) {
-  const std::string* ret=nullptr;
-  size_t       count=0;
-  auto         id = &node-bsp.nodes.data();(void)id;
+bool World::isInside(const phoenix::bsp_node& node, const Tempest::Vec3& p) {
+  return node.bbox.min.x <= p.x && p.x <node.bbox.max.x &&
+         node.bbox.min.y <= p.y && p.y <node.bbox.max.y &&
+         node.bbox.min.z <= p.z && p.z <node.bbox.max.z;
+  }
 
-  for(auto& i:bsp.sectors) {
-    for(auto r:i.node_indices)
-      if(r<bsp.leaf_node_indices.size()){
-        size_t idx = bsp.leaf_node_indices[r];
-        if(idx>=bsp.nodes.size())
-          continue;
-        if(&bsp.nodes[idx]==&node) {
-          ret = &i.name;
-          count++;
-          }
-        }
-    }
-  if(count==1) {
-    // TODO: portals
-    return *ret;
+void World::buildBspIndex() {
+  // leaf -> sector; leafs, that are shared by more than one sector, have no room (TODO: portals)
+  bspLeafSector.assign(bsp.nodes.size(),NoBspNode);
+  std::vector<uint32_t> count(bsp.nodes.size(),0);
+  for(size_t i=0; i<bsp.sectors.size(); ++i) {
+    for(auto r:bsp.sectors[i].node_indices) {
+      if(r>=bsp.leaf_node_indices.size())
+        continue;
+      size_t idx = bsp.leaf_node_indices[r];
+      if(idx>=bsp.nodes.size())
+        continue;
+      bspLeafSector[idx] = uint32_t(i);
+      count[idx]++;
+      }
     }
-  static std::string empty;
-  return empty;
+  for(size_t i=0; i<count.size(); ++i)
+    if(count[i]!=1)
+      bspLeafSector[i] = NoBspNode;
+
+  // names are owned by bsp-tree, first sector wins on duplicates
+  bspSectorId.clear();
+  bspSectorId.reserve(bsp.sectors.size());
+  for(size_t i=0; i<bsp.sectors.size(); ++i)
+    bspSectorId.emplace(bsp.sectors[i].name,uint32_t(i));
   }
 
 World::BspSector* World::portalAt(std::string_view tag) {
   if(tag.empty())
     return nullptr;
 
-  for(size_t i=0;i<bsp.sectors.size();++i)
-    if(bsp.sectors[i].name==tag)
-      return &bspSectors[i];
-  return nullptr;
+  auto i = bspSectorId.find(tag);
+  if(i==bspSectorId.end())
+    return nullptr;
+  return &bspSectors[i->second];
   }
 
 void World::scaleTime(uint64_t& dt) {
@@ -344,16 +378,34 @@ void World::tick(uint64_t dt) {
   static bool doTicks=true;
   if(!doTicks)
     return;
+  Profiler::Zone zone("World::tick");
   wobj.tick(dt,dt);
   wdynamic->tick(dt);
-  wview->tick(dt);
+  if(wview!=nullptr)
+    wview->tick(dt);
   if(auto pl = player())
     wsound.tick(*pl);
   globFx->tick(dt);
   }
 
+void World::dumpWaynetStats(const std::function<void(std::string_view)>& out) const {
+  wmatrix->dumpStats(out);
+  }
+
+void World::dumpLosStats(const std::function<void(std::string_view)>& out) const {
+  wobj.dumpLosStats(out);
+  }
+
+void World::dumpTriggerStats(const std::function<void(std::string_view)>& out) const {
+  wobj.dumpTriggerStats(out);
+  }
+
+void World::dumpSimLodStats(const std::function<void(std::string_view)>& out) const {
+  wobj.dumpSimLodStats(out);
+  }
+
 uint64_t World::tickCount() const {
-  return game.tickCount();
+  return game.tickCount()-catchUpLag;
   }
 
 void World::setDayTime(int32_t h, int32_t min) {
@@ -481,6 +533,10 @@ void World::disableCollizionZone(CollisionZone& z) {
   wobj.disableCollizionZone(z);
   }
 
+void World::invalidateCollizionZone(CollisionZone& z) {
+  wobj.invalidateCollizionZone(z);
+  }
+
 void World::triggerChangeWorld(std::string_view world, std::string_view wayPoint) {
   game.changeWorld(world,wayPoint);
   }
@@ -701,6 +757,8 @@ bool World::isInSfxRange(const Tempest::Vec3& pos) const {
   }
 
 bool World::isInPfxRange(const Tempest::Vec3& p) const {
+  if(wview==nullptr)
+    return false;
   return wview->isInPfxRange(p);
   }
 
@@ -737,8 +795,16 @@ void World::addSound(const phoenix::vob& vob) {
     }
   }
 
-void World::invalidateVobIndex() {
-  wobj.invalidateVobIndex();
+void World::invalidateVobIndex(const Vob& v) {
+  wobj.invalidateVobIndex(v);
+  }
+
+void World::invalidateNpcIndex(Npc& npc) {
+  wobj.invalidateNpcIndex(npc);
+  }
+
+bool World::testLineOfSight(const Npc& observer, const Npc& target) {
+  return wobj.testLineOfSight(observer,target);
   }
 
 const phoenix::c_focus& World::searchPolicy(const Npc& pl, TargetCollect& coll, WorldObjects::SearchFlg& opt) const {
@@ -834,10 +900,6 @@ const WayPoint& World::deadPoint() const {
   return wmatrix->deadPoint();
   }
 
-void World::detectNpcNear(std::function<void (Npc &)> f) {
-  wobj.detectNpcNear(f);
-  }
-
 void World::detectNpc(const Tempest::Vec3& p, const float r, const std::function<void(Npc&)>& f) {
   wobj.detectNpc(p.x,p.y,p.z,r,f);
   }
@@ -907,11 +969,7 @@ int32_t World::guildOfRoom(std::string_view portalName) {
     return -1;
 
   auto name = portalName.substr(b,e-b);
-
-  for(size_t i=0;i<bsp.sectors.size();++i) {
-    auto& s = bsp.sectors[i].name;
-    if(s==name)
-      return bspSectors[i].guild;
-    }
+  if(auto room=portalAt(name))
+    return room->guild;
   return GIL_NONE;
   }
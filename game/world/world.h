@@ -5,6 +5,7 @@
 #include <Tempest/Matrix4x4>
 #include <string>
 #include <functional>
+#include <unordered_map>
 
 #include <phoenix/world.hh>
 
@@ -40,6 +41,7 @@ class World final {
     struct BspSector final {
       int32_t guild=GIL_NONE;
       };
+    static constexpr uint32_t NoBspNode = uint32_t(-1);
 
     void                 createPlayer(std::string_view cls);
     void                 insertPlayer(std::unique_ptr<Npc>&& npc, std::string_view waypoint);
@@ -72,7 +74,6 @@ class World final {
 
     const WayPoint&      deadPoint() const;
 
-    void                 detectNpcNear(std::function<void(Npc&)> f);
     void                 detectNpc (const Tempest::Vec3& p, const float r, const std::function<void(Npc&)>& f);
     void                 detectItem(const Tempest::Vec3& p, const float r, const std::function<void(Item&)>& f);
 
@@ -111,10 +112,16 @@ class World final {
     Npc*                 player() const { return npcPlayer; }
     Npc*                 findNpcByInstance(size_t instance);
     std::string_view     roomAt(const Tempest::Vec3& arr);
+    std::string_view     roomAt(const Tempest::Vec3& arr, uint32_t& leaf);
 
     void                 scaleTime(uint64_t& dt);
     void                 tick(uint64_t dt);
+    void                 dumpWaynetStats(const std::function<void(std::string_view)>& out) const;
+    void                 dumpLosStats   (const std::function<void(std::string_view)>& out) const;
+    void                 dumpTriggerStats(const std::function<void(std::string_view)>& out) const;
+    void                 dumpSimLodStats (const std::function<void(std::string_view)>& out) const;
     uint64_t             tickCount() const;
+    void                 setCatchUpLag(uint64_t lag) { catchUpLag = lag; }
     void                 setDayTime(int32_t h,int32_t min);
     gtime                time() const;
 
@@ -131,6 +138,7 @@ class World final {
     void                 disableTicks(AbstractTrigger& t);
     void                 enableCollizionZone (CollisionZone& z);
     void                 disableCollizionZone(CollisionZone& z);
+    void                 invalidateCollizionZone(CollisionZone& z);
 
     Interactive*         aviableMob(const Npc &pl, std::string_view name);
     Interactive*         findInteractive(const Npc& pl);
@@ -176,7 +184,9 @@ class World final {
     void                 addFreePoint  (const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
     void                 addSound      (const phoenix::vob& vob);
 
-    void                 invalidateVobIndex();
+    void                 invalidateVobIndex(const Vob& v);
+    void                 invalidateNpcIndex(Npc& npc);
+    bool                 testLineOfSight(const Npc& observer, const Npc& target);
 
   private:
     const phoenix::c_focus&     searchPolicy(const Npc& pl, TargetCollect& coll, WorldObjects::SearchFlg& opt) const;
@@ -186,8 +196,11 @@ class World final {
     std::unique_ptr<WayMatrix>            wmatrix;
     phoenix::bsp_tree                     bsp;
     std::vector<BspSector>                bspSectors;
+    std::vector<uint32_t>                 bspLeafSector;
+    std::unordered_map<std::string_view,uint32_t> bspSectorId;
 
     Npc*                                  npcPlayer=nullptr;
+    uint64_t                              catchUpLag=0; // tickCount() of deferred npc tick, in past
 
     std::unique_ptr<DynamicWorld>         wdynamic;
     std::unique_ptr<WorldView>            wview;
@@ -196,8 +209,10 @@ class World final {
     WorldObjects                          wobj;
     std::unique_ptr<Npc>                  lvlInspector;
 
-    auto         roomAt(const phoenix::bsp_node &node) -> std::string_view;
     auto         portalAt(std::string_view tag) -> BspSector*;
+    uint32_t     bspLeafAt(const Tempest::Vec3& p) const;
+    void         buildBspIndex();
+    static bool  isInside(const phoenix::bsp_node& node, const Tempest::Vec3& p);
 
     void         initScripts(bool firstTime);
 
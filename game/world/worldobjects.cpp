@@ -10,6 +10,8 @@
 #include "world.h"
 #include "utils/workers.h"
 #include "utils/dbgpainter.h"
+#include "utils/profiler.h"
+#include "gothic.h"
 
 #include <Tempest/Painter>
 #include <Tempest/Application>
@@ -17,8 +19,21 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cstdio>
+
 using namespace Tempest;
 
+struct WorldObjects::DelayedEvent final {
+  TriggerEvent evt;
+  uint64_t     seq = 0;
+  bool operator > (const DelayedEvent& other) const {
+    if(evt.timeBarrier!=other.evt.timeBarrier)
+      return evt.timeBarrier>other.evt.timeBarrier;
+    return seq>other.seq;
+    }
+  };
+
 int32_t WorldObjects::MobStates::stateByTime(gtime t) const {
   t = t.timeInDay();
   for(size_t i=routines.size(); i>0; ) {
@@ -32,6 +47,23 @@ int32_t WorldObjects::MobStates::stateByTime(gtime t) const {
   return 0;
   }
 
+gtime WorldObjects::MobStates::nextChange(gtime t) const {
+  // offsets from midnight: 24:00 rolls over to the next day
+  const gtime time = t.timeInDay();
+  for(auto& i:routines)
+    if(time<i.time) {
+      gtime ret = gtime(t.day(),int32_t(0),int32_t(0));
+      ret.addMilis(uint64_t(i.time.toInt()));
+      return ret;
+      }
+  if(routines.size()>0) {
+    gtime ret = gtime(t.day()+1,int32_t(0),int32_t(0));
+    ret.addMilis(uint64_t(routines[0].time.toInt()));
+    return ret;
+    }
+  return gtime::endOfTime();
+  }
+
 void WorldObjects::MobStates::save(Serialize& fout) {
   fout.write(curState,scheme);
   fout.write(uint32_t(routines.size()));
@@ -54,8 +86,11 @@ WorldObjects::SearchOpt::SearchOpt(float rangeMin, float rangeMax, float azi, Ta
   :rangeMin(rangeMin),rangeMax(rangeMax),azi(azi),collectAlgo(collectAlgo),flags(flags) {
   }
 
-WorldObjects::WorldObjects(World& owner):owner(owner){
+WorldObjects::WorldObjects(World& owner):owner(owner),los(owner){
   npcNear.reserve(512);
+  los.setCacheTime(uint64_t(std::max(0,Gothic::settingsGetI("GAME","losCacheTime"))));
+  simFarInterval = uint64_t(std::clamp(Gothic::settingsGetI("GAME","simFarInterval"),10,int(SimMaxStep)));
+  simFar2Budget  = uint32_t(std::max(0,Gothic::settingsGetI("GAME","simFar2Ticks")));
   }
 
 WorldObjects::~WorldObjects() {
@@ -69,6 +104,7 @@ void WorldObjects::load(Serialize &fin) {
   fin.setVersion(v);
   }
   itemArr.clear();
+  itmIds.clear();
   items.clear();
 
   uint32_t sz = fin.directorySize("worlds/",fin.worldName(),"/npc/");
@@ -78,13 +114,13 @@ void WorldObjects::load(Serialize &fin) {
   for(size_t i=0; i<npcArr.size(); ++i) {
     npcArr[i]->load(fin,i);
     }
+  rebuildNpcIndex();
 
   fin.setEntry("worlds/",fin.worldName(),"/items");
   fin.read(sz);
   for(size_t i=0; i<sz; ++i) {
     auto it = std::make_unique<Item>(owner,fin,Item::T_World);
-    itemArr.emplace_back(std::move(it));
-    items.add(itemArr.back().get());
+    pushItem(std::move(it));
     }
 
   for(auto& i:rootVobs)
@@ -101,6 +137,7 @@ void WorldObjects::load(Serialize &fin) {
   routines.resize(sz);
   for(auto& i:routines)
     i.load(fin);
+  routineUntil = gtime();
 
   for(auto& i:interactiveObj)
     i->postValidate();
@@ -126,8 +163,18 @@ void WorldObjects::save(Serialize &fout) {
   for(auto& i:rootVobs)
     i->saveVobTree(fout);
 
+  // delayed events are saved in order of arrival, and go back to the heap on first tick after load
+  std::vector<const DelayedEvent*> delayed(triggerDelayed.size());
+  for(size_t i=0; i<triggerDelayed.size(); ++i)
+    delayed[i] = &triggerDelayed[i];
+  std::sort(delayed.begin(),delayed.end(),[](const DelayedEvent* a, const DelayedEvent* b){
+    return a->seq<b->seq;
+    });
+
   fout.setEntry("worlds/",fout.worldName(),"/triggerEvents");
-  fout.write(uint32_t(triggerEvents.size()));
+  fout.write(uint32_t(delayed.size()+triggerEvents.size()));
+  for(auto i:delayed)
+    i->evt.save(fout);
   for(auto& i:triggerEvents)
     i.save(fout);
 
@@ -138,6 +185,7 @@ void WorldObjects::save(Serialize &fout) {
   }
 
 void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
+  Profiler::Zone zone("WorldObjects::tick");
   auto passive=std::move(sndPerc);
   sndPerc.clear();
 
@@ -155,22 +203,17 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     std::sort(npcArr.begin(),npcArr.end(),[](std::unique_ptr<Npc>& a, std::unique_ptr<Npc>& b){
       return a->handle().id<b->handle().id;
       });
+    for(size_t i=0; i<npcArr.size(); ++i)
+      npcIds[npcArr[i].get()] = uint32_t(i);
     }
 
-  for(size_t i=0; i<npcArr.size(); ++i) {
-    auto& npc = *npcArr[i];
-    if(npc.isPlayer())
-      npc.tick(dtPlayer); else
-      npc.tick(dt);
-    }
+  for(size_t i=0; i<npcArr.size(); ++i)
+    tickNpc(*npcArr[i],dt,dtPlayer);
+  tickFar2();
 
-  for(auto& i:routines) {
-    auto s = i.stateByTime(owner.time());
-    if(s!=i.curState) {
-      setMobState(i.scheme,s);
-      i.curState = s;
-      }
-    }
+  const gtime now = owner.time();
+  if(now<routineFrom || routineUntil<=now)
+    tickMobRoutines(now);
 
   for(auto& i:interactiveObj)
     i->tick(dt);
@@ -198,28 +241,49 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
     return;
 
   npcNear.clear();
+  std::swap(npcActive,npcActivePrev);
+  npcActive.clear();
+
+  const float farRange = 6000;
   const float nearDist = 3000*3000;
-  const float farDist  = 6000*6000;
+  const float farDist  = farRange*farRange;
 
+  // only npc's around player are visited; everything else stays at AiFar2
   auto plPos = pl->position();
-  for(auto& i:npcArr) {
-    float dist = (i->position()-plPos).quadLength();
+  npcGrid.find(plPos,farRange,[&](Npc& i){
+    float dist = (i.position()-plPos).quadLength();
     if(dist<nearDist){
-      npcNear.push_back(i.get());
-      if(i.get()!=pl)
-        i->setProcessPolicy(Npc::ProcessPolicy::AiNormal);
+      npcNear.push_back(&i);
+      npcActive.push_back(&i);
+      if(&i!=pl)
+        i.setProcessPolicy(Npc::ProcessPolicy::AiNormal);
       } else
     if(dist<farDist) {
-      i->setProcessPolicy(Npc::ProcessPolicy::AiFar);
-      } else {
-      i->setProcessPolicy(Npc::ProcessPolicy::AiFar2);
+      npcActive.push_back(&i);
+      i.setProcessPolicy(Npc::ProcessPolicy::AiFar);
       }
+    });
+  for(auto i:npcActivePrev) {
+    if((i->position()-plPos).quadLength()>=farDist)
+      i->setProcessPolicy(Npc::ProcessPolicy::AiFar2);
     }
+  // keep same processing order, as npcArr
+  std::sort(npcNear.begin(),npcNear.end(),[](const Npc* a, const Npc* b){
+    return a->handle().id<b->handle().id;
+    });
   tickNear(dt);
   for(CollisionZone* z:collisionZn)
     z->tick(dt);
   tickTriggers(dt);
 
+  // visibility tests of this round of perception are resolved as one batch
+  for(auto ptr:npcNear) {
+    if(ptr->isPlayer() || ptr->isDead() || ptr->percNextTime()>owner.tickCount())
+      continue;
+    ptr->submitSenseQueries(los);
+    }
+  los.flush();
+
   for(auto& ptr:npcNear) {
     Npc& i = *ptr;
     if(i.isPlayer() || i.isDead())
@@ -250,32 +314,29 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
 
     i.perceptionProcess(*pl);
     }
+  los.frame();
   }
 
 uint32_t WorldObjects::npcId(const Npc *ptr) const {
   if(ptr==nullptr)
     return uint32_t(-1);
-  for(size_t i=0;i<npcArr.size();++i)
-    if(npcArr[i].get()==ptr)
-      return uint32_t(i);
-  return uint32_t(-1);
+  auto it = npcIds.find(ptr);
+  if(it==npcIds.end())
+    return uint32_t(-1);
+  return it->second;
   }
 
 uint32_t WorldObjects::itmId(const void *ptr) const {
-  for(size_t i=0;i<itemArr.size();++i)
-    if(&itemArr[i]->handle()==ptr)
-      return uint32_t(i);
-  return uint32_t(-1);
+  if(ptr==nullptr)
+    return uint32_t(-1);
+  auto it = itmIds.find(ptr);
+  if(it==itmIds.end())
+    return uint32_t(-1);
+  return it->second;
   }
 
-uint32_t WorldObjects::mobsiId(const void* ptr) const {
-  uint32_t ret=0;
-  for(auto& i:interactiveObj) {
-    if(i==ptr)
-      return ret;
-    ++ret;
-    }
-  return uint32_t(-1);
+uint32_t WorldObjects::mobsiId(const Interactive* ptr) const {
+  return interactiveObj.indexOf(ptr);
   }
 
 Npc* WorldObjects::addNpc(size_t npcInstance, std::string_view at) {
@@ -307,7 +368,10 @@ Npc* WorldObjects::addNpc(size_t npcInstance, std::string_view at) {
     npc->setDirection (pos->dirX,pos->dirY,pos->dirZ);
     npc->attachToPoint(pos);
     npc->updateTransform();
+    npcIds[npc] = uint32_t(npcArr.size());
     npcArr.emplace_back(npc);
+    npcGrid.insert(*npc,npc->position());
+    npcActive.push_back(npc);
     } else {
     auto& point = owner.deadPoint();
     npc->attachToPoint(nullptr);
@@ -325,7 +389,10 @@ Npc* WorldObjects::addNpc(size_t npcInstance, const Vec3& pos) {
   //npc->setDirection (pos->dirX,pos->dirY,pos->dirZ);
   npc->updateTransform();
 
+  npcIds[npc] = uint32_t(npcArr.size());
   npcArr.emplace_back(npc);
+  npcGrid.insert(*npc,npc->position());
+  npcActive.push_back(npc);
   return npc;
   }
 
@@ -347,29 +414,143 @@ Npc* WorldObjects::insertPlayer(std::unique_ptr<Npc> &&npc, std::string_view at)
     npc->attachToPoint(pos);
     npc->updateTransform();
     }
+  npcIds[npc.get()] = uint32_t(npcArr.size());
   npcArr.emplace_back(std::move(npc));
+  npcGrid.insert(*npcArr.back(),npcArr.back()->position());
+  npcActive.push_back(npcArr.back().get());
   return npcArr.back().get();
   }
 
 std::unique_ptr<Npc> WorldObjects::takeNpc(const Npc* ptr) {
-  for(size_t i=0; i<npcArr.size(); ++i){
-    auto& npc=*npcArr[i];
-    if(&npc==ptr){
-      auto ret=std::move(npcArr[i]);
-      npcArr[i] = std::move(npcArr.back());
-      npcArr.pop_back();
-      return ret;
+  const uint32_t i = npcId(ptr);
+  if(i==uint32_t(-1))
+    return nullptr;
+
+  auto ret=std::move(npcArr[i]);
+  npcArr[i] = std::move(npcArr.back());
+  npcArr.pop_back();
+  npcIds.erase(ptr);
+  if(i<npcArr.size())
+    npcIds[npcArr[i].get()] = i;
+  npcGrid.erase(*ret);
+  los.erase(*ret);
+  npcNear      .erase(std::remove(npcNear.begin(),      npcNear.end(),      ptr),npcNear.end());
+  npcActive    .erase(std::remove(npcActive.begin(),    npcActive.end(),    ptr),npcActive.end());
+  npcActivePrev.erase(std::remove(npcActivePrev.begin(),npcActivePrev.end(),ptr),npcActivePrev.end());
+  return ret;
+  }
+
+void WorldObjects::rebuildNpcIndex() {
+  // every npc starts as active, to be classified at next tick
+  npcGrid.clear();
+  npcNear.clear();
+  npcActive.clear();
+  npcActivePrev.clear();
+  npcIds.clear();
+  for(size_t id=0; id<npcArr.size(); ++id) {
+    auto& i = npcArr[id];
+    npcIds[i.get()] = uint32_t(id);
+    npcGrid.insert(*i,i->position());
+    npcActive.push_back(i.get());
+    }
+  }
+
+void WorldObjects::invalidateNpcIndex(Npc& npc) {
+  npcGrid.move(npc,npc.position());
+  }
+
+bool WorldObjects::testLineOfSight(const Npc& observer, const Npc& target) {
+  return los.test(observer,target);
+  }
+
+void WorldObjects::dumpLosStats(const std::function<void(std::string_view)>& out) const {
+  los.dumpStats(out);
+  }
+
+void WorldObjects::tickNpc(Npc& npc, uint64_t dt, uint64_t dtPlayer) {
+  const auto policy = npc.processPolicy();
+  switch(policy) {
+    case Npc::ProcessPolicy::Player:
+    case Npc::ProcessPolicy::AiNormal: {
+      const uint64_t frame = (policy==Npc::ProcessPolicy::Player ? dtPlayer : dt);
+      if(npc.deferredTime()==0) {
+        npc.tick(frame);
+        simStats.ticks[policy]++;
+        break;
+        }
+      // promoted from far: catch-up is limited per frame; frame tick resumes, once debt is less than a step
+      npc.deferTick(frame);
+      simStats.catchUp += npc.tickDeferred(SimMaxStep,SimMaxCatchUp);
+      if(npc.deferredTime()<SimMaxStep) {
+        npc.tickRemainder();
+        simStats.ticks[policy]++;
+        }
+      break;
       }
+    case Npc::ProcessPolicy::AiFar:
+      npc.deferTick(dt);
+      simStats.ticks[policy] += npc.tickDeferred(simFarInterval,SimMaxCatchUp);
+      break;
+    case Npc::ProcessPolicy::AiFar2:
+      npc.deferTick(dt);
+      if(simFar2Budget==0)
+        simStats.ticks[policy] += npc.tickDeferred(SimMaxStep,SimMaxCatchUp);
+      break;
+    }
+  }
+
+void WorldObjects::tickFar2() {
+  if(simFar2Budget==0)
+    return;
+  // budget is counted in steps, not in wall-clock time: same npc's are visited on any machine
+  uint32_t budget = simFar2Budget;
+
+  // at most one full pass per frame; cursor is kept, so every npc is eventually visited
+  for(size_t visited=0; visited<npcArr.size(); ++visited) {
+    if(simFar2Cursor>=npcArr.size()) {
+      simFar2Cursor = 0;
+      simStats.far2Swept++;
+      }
+    Npc& npc = *npcArr[simFar2Cursor];
+    ++simFar2Cursor;
+    if(npc.processPolicy()!=Npc::ProcessPolicy::AiFar2 || npc.deferredTime()==0)
+      continue;
+    const uint32_t cnt = npc.tickDeferred(SimMaxStep,std::min(budget,SimMaxCatchUp));
+    simStats.ticks[Npc::ProcessPolicy::AiFar2] += cnt;
+    budget -= cnt;
+    if(budget==0)
+      break;
     }
-  return nullptr;
   }
 
 void WorldObjects::tickNear(uint64_t /*dt*/) {
+  collisionIdx.update();
+  // callbacks may enable new zones: collect hits first
+  std::vector<CollisionZone*> hit;
   for(Npc* i:npcNear) {
     auto pos = i->position() + Vec3(0,i->translateY(),0);
-    for(CollisionZone* z:collisionZn)
-      if(z->checkPos(pos))
-        z->onIntersect(*i);
+    hit.clear();
+    collisionIdx.find(pos,[&hit,&pos](CollisionZone& z){
+      if(z.checkPos(pos))
+        hit.push_back(&z);
+      });
+    for(auto z:hit)
+      z->onIntersect(*i);
+    }
+  }
+
+void WorldObjects::tickMobRoutines(gtime now) {
+  routineFrom  = now;
+  routineUntil = gtime::endOfTime();
+  for(auto& i:routines) {
+    auto s = i.stateByTime(now);
+    if(s!=i.curState) {
+      setMobState(i.scheme,s);
+      i.curState = s;
+      }
+    auto next = i.nextChange(now);
+    if(next<routineUntil)
+      routineUntil = next;
     }
   }
 
@@ -377,6 +558,14 @@ void WorldObjects::tickTriggers(uint64_t /*dt*/) {
   auto evt = std::move(triggerEvents);
   triggerEvents.clear();
 
+  const uint64_t time = owner.tickCount();
+  while(!triggerDelayed.empty() && triggerDelayed.front().evt.timeBarrier<=time) {
+    std::pop_heap(triggerDelayed.begin(),triggerDelayed.end(),std::greater<>());
+    auto e = std::move(triggerDelayed.back().evt);
+    triggerDelayed.pop_back();
+    execTriggerEvent(e);
+    }
+
   for(auto& e:evt)
     execTriggerEvent(e);
   }
@@ -387,20 +576,22 @@ void WorldObjects::triggerEvent(const TriggerEvent &e) {
 
 void WorldObjects::execTriggerEvent(const TriggerEvent& e) {
   if(e.timeBarrier>owner.tickCount()) {
-    triggerEvent(std::move(e));
+    triggerDelayed.push_back(DelayedEvent{e,triggerSeq++});
+    std::push_heap(triggerDelayed.begin(),triggerDelayed.end(),std::greater<>());
+    trgStats.deferred++;
     return;
     }
 
-  bool emitted=false;
-  for(auto& i:triggers) {
-    auto& t = *i;
-    if(t.name()==e.target) { // NOTE: trigger name is not unique - more then one trigger can be activated
-      t.processEvent(e);
-      emitted=true;
-      }
-    }
-  if(!emitted)
+  // NOTE: trigger name is not unique - more then one trigger can be activated
+  auto& tg = triggersByName.findAll(e.target);
+  if(tg.empty()) {
+    trgStats.unmatched++;
     Log::d("unable to process trigger: \"",e.target,"\"");
+    return;
+    }
+  trgStats.dispatched++;
+  for(auto t:tg)
+    t->processEvent(e);
   }
 
 void WorldObjects::updateAnimation(uint64_t dt) {
@@ -416,12 +607,11 @@ void WorldObjects::updateAnimation(uint64_t dt) {
   }
 
 bool WorldObjects::isTargeted(Npc& dst) {
-  std::atomic_flag flg = ATOMIC_FLAG_INIT;
-  Workers::parallelFor(npcArr,[&dst,&flg](std::unique_ptr<Npc>& i) {
+  // only AiNormal npc can attack, and those are near to player
+  for(auto i:npcNear)
     if(isTargetedBy(*i,dst))
-      flg.test_and_set();
-    });
-  return flg.test_and_set();
+      return true;
+  return false;
   }
 
 bool WorldObjects::isTargetedBy(Npc& npc, Npc& dst) {
@@ -449,19 +639,15 @@ Npc *WorldObjects::findNpcByInstance(size_t instance) {
   return nullptr;
   }
 
-void WorldObjects::detectNpcNear(const std::function<void(Npc&)>& f) {
-  for(auto& i:npcNear)
-    f(*i);
-  }
-
 void WorldObjects::detectNpc(const float x, const float y, const float z,
                              const float r, const std::function<void(Npc&)>& f) {
-  float maxDist=r*r;
-  for(auto& i:npcArr) {
-    auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
+  const Vec3  pos     = {x,y,z};
+  const float maxDist = r*r;
+  npcGrid.find(pos,r,[&](Npc& i){
+    auto qDist = (i.position()-pos).quadLength();
     if(qDist<maxDist)
-      f(*i);
-    }
+      f(i);
+    });
   }
 
 void WorldObjects::detectItem(const float x, const float y, const float z,
@@ -478,6 +664,7 @@ void WorldObjects::addTrigger(AbstractTrigger* tg) {
   if(tg->hasVolume())
     triggersZn.emplace_back(tg);
   triggers.emplace_back(tg);
+  triggersByName.insert(tg->name(),tg);
   }
 
 void WorldObjects::triggerOnStart(bool firstTime) {
@@ -502,11 +689,54 @@ void WorldObjects::disableTicks(AbstractTrigger& t) {
       }
   }
 
+void WorldObjects::dumpTriggerStats(const std::function<void(std::string_view)>& out) const {
+  char buf[256] = {};
+  std::snprintf(buf,sizeof(buf),"triggers: %d, names: %d, ticking: %d, zones: %d",
+                int(triggers.size()),int(triggersByName.size()),int(triggersTk.size()),int(triggersZn.size()));
+  out(buf);
+  std::snprintf(buf,sizeof(buf),"  events: dispatched: %llu, deferred: %llu, unmatched: %llu, queued: %d, delayed: %d",
+                static_cast<unsigned long long>(trgStats.dispatched),
+                static_cast<unsigned long long>(trgStats.deferred),
+                static_cast<unsigned long long>(trgStats.unmatched),
+                int(triggerEvents.size()),int(triggerDelayed.size()));
+  out(buf);
+  std::snprintf(buf,sizeof(buf),"  collision zones: %d, rebuilds: %u",
+                int(collisionIdx.size()),unsigned(collisionIdx.rebuildCount()));
+  out(buf);
+  }
+
+void WorldObjects::dumpSimLodStats(const std::function<void(std::string_view)>& out) const {
+  size_t cnt[4] = {};
+  for(auto& i:npcArr)
+    cnt[i->processPolicy()]++;
+
+  char buf[256] = {};
+  std::snprintf(buf,sizeof(buf),"simulation lod: far step: %llu ms, far2 budget: %u steps per frame",
+                static_cast<unsigned long long>(simFarInterval),simFar2Budget);
+  out(buf);
+  static const char* names[] = {"player", "normal", "far", "far2"};
+  for(size_t i=0; i<4; ++i) {
+    std::snprintf(buf,sizeof(buf),"  %-6s npc: %d, ticks: %llu",
+                  names[i],int(cnt[i]),static_cast<unsigned long long>(simStats.ticks[i]));
+    out(buf);
+    }
+  std::snprintf(buf,sizeof(buf),"  catch-up ticks: %llu, far2 sweeps: %llu",
+                static_cast<unsigned long long>(simStats.catchUp),
+                static_cast<unsigned long long>(simStats.far2Swept));
+  out(buf);
+  }
+
 void WorldObjects::enableCollizionZone(CollisionZone& z) {
   collisionZn.push_back(&z);
+  collisionIdx.insert(z);
+  }
+
+void WorldObjects::invalidateCollizionZone(CollisionZone& z) {
+  collisionIdx.invalidate(z);
   }
 
 void WorldObjects::disableCollizionZone(CollisionZone& z) {
+  collisionIdx.erase(z);
   for(auto& i:collisionZn)
     if(i==&z) {
       i = collisionZn.back();
@@ -544,17 +774,26 @@ Item* WorldObjects::addItem(const phoenix::vobs::item& vob) {
   }
 
 std::unique_ptr<Item> WorldObjects::takeItem(Item &it) {
-  for(auto& i:itemArr)
-    if(i.get()==&it){
-      auto ret=std::move(i);
-      i = std::move(itemArr.back());
-      itemArr.pop_back();
-      items.del(ret.get());
-      ret->setPhysicsDisable();
-      onItemRemoved(*ret);
-      return ret;
-      }
-  return nullptr;
+  const uint32_t i = itmId(&it.handle());
+  if(i==uint32_t(-1) || itemArr[i].get()!=&it)
+    return nullptr;
+
+  auto ret=std::move(itemArr[i]);
+  itemArr[i] = std::move(itemArr.back());
+  itemArr.pop_back();
+  itmIds.erase(&ret->handle());
+  if(i<itemArr.size())
+    itmIds[&itemArr[i]->handle()] = i;
+  items.del(ret.get());
+  ret->setPhysicsDisable();
+  onItemRemoved(*ret);
+  return ret;
+  }
+
+void WorldObjects::pushItem(std::unique_ptr<Item>&& it) {
+  itmIds[&it->handle()] = uint32_t(itemArr.size());
+  itemArr.emplace_back(std::move(it));
+  items.add(itemArr.back().get());
   }
 
 void WorldObjects::removeItem(Item &it) {
@@ -564,10 +803,8 @@ void WorldObjects::removeItem(Item &it) {
   }
 
 size_t WorldObjects::hasItems(std::string_view tag, size_t itemCls) {
-  for(auto& i:interactiveObj)
-    if(i->tag()==tag) {
-      return i->inventory().itemCount(itemCls);
-      }
+  if(auto i = interactiveByName.find(tag))
+    return i->inventory().itemCount(itemCls);
   return 0;
   }
 
@@ -613,8 +850,7 @@ Item* WorldObjects::addItem(size_t itemInstance, const Tempest::Vec3& pos, const
 
   std::unique_ptr<Item> ptr{new Item(owner,itemInstance,Item::T_World)};
   auto* it=ptr.get();
-  itemArr.emplace_back(std::move(ptr));
-  items.add(itemArr.back().get());
+  pushItem(std::move(ptr));
 
   it->setPosition (pos.x, pos.y, pos.z);
   it->setDirection(dir.x, dir.y, dir.z);
@@ -636,8 +872,7 @@ Item* WorldObjects::addItemDyn(size_t itemInstance, const Tempest::Matrix4x4& po
 
   auto* it=ptr.get();
   it->handle().owner = ownerNpc==size_t(-1) ? 0 : uint32_t(ownerNpc);
-  itemArr.emplace_back(std::move(ptr));
-  items.add(itemArr.back().get());
+  pushItem(std::move(ptr));
 
   it->setObjMatrix(pos);
 
@@ -646,6 +881,7 @@ Item* WorldObjects::addItemDyn(size_t itemInstance, const Tempest::Matrix4x4& po
 
 void WorldObjects::addInteractive(Interactive* obj) {
   interactiveObj.add(obj);
+  interactiveByName.insert(obj->tag(),obj);
   }
 
 void WorldObjects::addStatic(StaticObj* obj) {
@@ -659,9 +895,9 @@ void WorldObjects::addRoot(const std::unique_ptr<phoenix::vob>& vob, bool startu
   rootVobs.emplace_back(std::move(p));
   }
 
-void WorldObjects::invalidateVobIndex() {
-  items.invalidate();
-  interactiveObj.invalidate();
+void WorldObjects::invalidateVobIndex(const Vob& v) {
+  items.invalidate(&v);
+  interactiveObj.invalidate(&v);
   }
 
 Interactive* WorldObjects::validateInteractive(Interactive *def) {
@@ -800,6 +1036,7 @@ void WorldObjects::setMobRoutine(gtime time, std::string_view scheme, int32_t st
       std::sort(i.routines.begin(),i.routines.end(),[](const MobRoutine& l, const MobRoutine& r){
         return l.time<r.time;
         });
+      routineUntil = gtime();
       return;
       }
     }
@@ -807,6 +1044,7 @@ void WorldObjects::setMobRoutine(gtime time, std::string_view scheme, int32_t st
   st.scheme = scheme;
   st.routines.push_back(r);
   routines.emplace_back(std::move(st));
+  routineUntil = gtime();
   }
 
 void WorldObjects::sendPassivePerc(Npc &self, Npc &other, Npc &victum, int32_t perc) {
@@ -855,10 +1093,12 @@ void WorldObjects::resetPositionToTA() {
       npc.updateTransform();
       }
     }
+  rebuildNpcIndex();
   for(auto& i:routines) {
     auto s = i.stateByTime(owner.time());
     i.curState = s;
     }
+  routineUntil = gtime();
   for(auto& i:interactiveObj) {
     int32_t state = -1;
     for(auto& r:routines) {
@@ -2,11 +2,17 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
+#include <unordered_map>
 
 #include <phoenix/vobs/misc.hh>
 
 #include "bullet.h"
 #include "spaceindex.h"
+#include "npcgrid.h"
+#include "lineofsight.h"
+#include "zoneindex.h"
+#include "nameindex.h"
 #include "game/gametime.h"
 #include "game/perceptionmsg.h"
 #include "game/constants.h"
@@ -60,7 +66,6 @@ class WorldObjects final {
     bool           isTargeted(Npc& npc);
     Npc*           findHero();
     Npc*           findNpcByInstance(size_t instance);
-    void           detectNpcNear(const std::function<void(Npc&)>& f);
     void           detectNpc (const float x, const float y, const float z, const float r, const std::function<void(Npc&)>&  f);
     void           detectItem(const float x, const float y, const float z, const float r, const std::function<void(Item&)>& f);
 
@@ -75,7 +80,7 @@ class WorldObjects final {
 
     size_t         mobsiCount()    const { return interactiveObj.size();        }
     Interactive&   mobsi(size_t i)       { return **(interactiveObj.begin()+i); }
-    uint32_t       mobsiId(const void* ptr) const;
+    uint32_t       mobsiId(const Interactive* ptr) const;
 
     void           addTrigger(AbstractTrigger* trigger);
     void           triggerEvent(const TriggerEvent& e);
@@ -83,8 +88,10 @@ class WorldObjects final {
     void           execTriggerEvent(const TriggerEvent& e);
     void           enableTicks (AbstractTrigger& t);
     void           disableTicks(AbstractTrigger& t);
+    void           dumpTriggerStats(const std::function<void(std::string_view)>& out) const;
     void           enableCollizionZone (CollisionZone& z);
     void           disableCollizionZone(CollisionZone& z);
+    void           invalidateCollizionZone(CollisionZone& z);
 
     void           runEffect(Effect&& e);
     void           stopEffect(const VisualFx& vfx);
@@ -104,7 +111,11 @@ class WorldObjects final {
     void           addInteractive(Interactive*         obj);
     void           addStatic     (StaticObj*           obj);
     void           addRoot       (const std::unique_ptr<phoenix::vob>& vob, bool startup);
-    void           invalidateVobIndex();
+    void           invalidateVobIndex(const Vob& v);
+    void           invalidateNpcIndex(Npc& npc);
+    bool           testLineOfSight(const Npc& observer, const Npc& target);
+    void           dumpLosStats(const std::function<void(std::string_view)>& out) const;
+    void           dumpSimLodStats(const std::function<void(std::string_view)>& out) const;
 
     Interactive*   validateInteractive(Interactive *def);
     Npc*           validateNpc        (Npc         *def);
@@ -136,6 +147,7 @@ class WorldObjects final {
       std::vector<MobRoutine> routines;
       int32_t                 curState = 0;
       int32_t                 stateByTime(gtime t) const;
+      gtime                   nextChange (gtime t) const;
       void                    save(Serialize& fout);
       void                    load(Serialize& fin);
       };
@@ -148,21 +160,45 @@ class WorldObjects final {
     World&                             owner;
 
     std::vector<CollisionZone*>        collisionZn;
+    ZoneIndex                          collisionIdx;
     std::vector<std::unique_ptr<Vob>>  rootVobs;
 
     SpaceIndex<Interactive>            interactiveObj;
+    NameIndex<Interactive>             interactiveByName;
     SpaceIndex<Item>                   items;
 
     std::vector<StaticObj*>            objStatic;
     std::vector<std::unique_ptr<Item>> itemArr;
     std::list<MobStates>               routines;
+    // mob routines are re-evaluated only within [routineFrom, routineUntil) of world time
+    gtime                              routineFrom;
+    gtime                              routineUntil;
 
     std::list<Bullet>                  bullets;
     std::vector<EffectState>           effects;
 
     std::vector<std::unique_ptr<Npc>>  npcArr;
+    std::unordered_map<const Npc*,uint32_t>  npcIds; // position in npcArr, as written to savegame
+    std::unordered_map<const void*,uint32_t> itmIds; // script handle -> position in itemArr
     std::vector<std::unique_ptr<Npc>>  npcInvalid;
     std::vector<Npc*>                  npcNear;
+    std::vector<Npc*>                  npcActive, npcActivePrev; // npc's within far-distance, as of last tick
+    NpcGrid                            npcGrid;
+    LineOfSight                        los;
+
+    // simulation LOD: AiFar npc's tick in steps of simFarInterval ms, AiFar2 - in steps of SimMaxStep,
+    // round-robin up to simFar2Budget steps per frame. Steps are aligned to world time, see Npc::tickDeferred
+    static constexpr uint64_t          SimMaxStep    = 100; // ms, single step of deferred simulation
+    static constexpr uint32_t          SimMaxCatchUp = 10;  // steps per npc per frame
+    uint64_t                           simFarInterval = 0;
+    uint32_t                           simFar2Budget  = 0;
+    size_t                             simFar2Cursor  = 0;
+    struct SimLodStats final {
+      uint64_t ticks[4]  = {}; // by Npc::ProcessPolicy
+      uint64_t catchUp   = 0;  // ticks, to simulate deferred time on promotion to AiNormal
+      uint64_t far2Swept = 0;  // complete round-robin passes over AiFar2
+      };
+    SimLodStats                        simStats;
 
     std::vector<AbstractTrigger*>      triggers;
     std::vector<AbstractTrigger*>      triggersZn;
@@ -170,6 +206,19 @@ class WorldObjects final {
     std::vector<PerceptionMsg>         sndPerc;
     std::vector<TriggerEvent>          triggerEvents;
 
+    // events with time-barrier: min-heap by (timeBarrier, order of arrival)
+    struct DelayedEvent;
+    NameIndex<AbstractTrigger>         triggersByName;
+    std::vector<DelayedEvent>          triggerDelayed;
+    uint64_t                           triggerSeq = 0;
+
+    struct TriggerStats final {
+      uint64_t dispatched = 0;
+      uint64_t deferred   = 0;
+      uint64_t unmatched  = 0;
+      };
+    TriggerStats                       trgStats;
+
     template<class T>
     auto findObj(T &src, const Npc &pl, const SearchOpt& opt) -> typename std::remove_reference<decltype(src[0])>::type*;
 
@@ -180,7 +229,12 @@ class WorldObjects final {
 
     void             setMobState(std::string_view scheme, int32_t st);
 
+    void             rebuildNpcIndex();
+    void             tickNpc(Npc& npc, uint64_t dt, uint64_t dtPlayer);
+    void             tickFar2();
+    void             pushItem(std::unique_ptr<Item>&& it);
     void             tickNear(uint64_t dt);
     void             tickTriggers(uint64_t dt);
+    void             tickMobRoutines(gtime now);
     static bool      isTargetedBy(Npc& npc,Npc& by);
   };
@@ -206,11 +206,17 @@ void WorldSound::tickSoundZone(Npc& player) {
      currentZone->checkPos(plPos.x,plPos.y+player.translateY(),plPos.z)){
     zone = currentZone;
     } else {
-    for(auto& z:zones) {
-      if(z.checkPos(plPos.x,plPos.y+player.translateY(),plPos.z)) {
-        zone = &z;
-        }
-      }
+    if(zoneTree.size()!=zones.size())
+      buildZoneTree();
+    // last zone in declaration order wins
+    const Tempest::Vec3 p = {plPos.x,plPos.y+player.translateY(),plPos.z};
+    size_t              id = size_t(-1);
+    zoneTree.find(p,[this,&p,&id](uint32_t i){
+      if(zones[i].checkPos(p.x,p.y,p.z) && (id==size_t(-1) || i>id))
+        id = i;
+      });
+    if(id!=size_t(-1))
+      zone = &zones[id];
     }
 
   gtime           time  = owner.time().timeInDay();
@@ -252,6 +258,16 @@ void WorldSound::tickSoundZone(Npc& player) {
         }
   }
 
+void WorldSound::buildZoneTree() {
+  std::vector<BoxTree::Box> boxes(zones.size());
+  for(size_t i=0; i<zones.size(); ++i) {
+    boxes[i].min = zones[i].bbox[0];
+    boxes[i].max = zones[i].bbox[1];
+    boxes[i].id  = uint32_t(i);
+    }
+  zoneTree.build(std::move(boxes));
+  }
+
 void WorldSound::tickSlot(std::vector<PEffect>& effect) {
   for(size_t i=0;i<effect.size();) {
     auto& e = *effect[i];
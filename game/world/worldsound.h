@@ -11,6 +11,7 @@
 
 #include "game/gametime.h"
 #include "gamemusic.h"
+#include "boxtree.h"
 
 class GameSession;
 class World;
@@ -57,6 +58,7 @@ class WorldSound final {
     using PEffect = std::shared_ptr<Effect>;
 
     void    tickSoundZone(Npc& player);
+    void    buildZoneTree();
     void    tickSlot(std::vector<PEffect>& eff);
     void    tickSlot(Effect& slot);
     void    initSlot(Effect& slot);
@@ -69,6 +71,7 @@ class WorldSound final {
     World&                                  owner;
 
     std::vector<Zone>                       zones;
+    BoxTree                                 zoneTree;
     std::unique_ptr<Zone>                   def;
 
     uint64_t                                nextSoundUpdate=0;
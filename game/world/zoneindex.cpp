@@ -0,0 +1,100 @@
+#include "zoneindex.h"
+
+#include <algorithm>
+
+#include "collisionzone.h"
+
+void ZoneIndex::insert(CollisionZone& z) {
+  if(slots.find(&z)!=slots.end())
+    return;
+  pushLoose(z);
+  }
+
+void ZoneIndex::erase(const CollisionZone& z) {
+  auto it = slots.find(&z);
+  if(it==slots.end())
+    return;
+  const Slot s = it->second;
+  slots.erase(it);
+
+  if(s.loc==L_Tree) {
+    tree[s.id] = nullptr;
+    holes++;
+    return;
+    }
+
+  if(z.isDynamic())
+    dynamic--;
+  loose[s.id] = loose.back();
+  loose.pop_back();
+  if(s.id<loose.size())
+    slots[loose[s.id]].id = s.id;
+  }
+
+void ZoneIndex::invalidate(CollisionZone& z) {
+  auto it = slots.find(&z);
+  if(it==slots.end() || it->second.loc==L_Loose)
+    return;
+  tree[it->second.id] = nullptr;
+  holes++;
+  slots.erase(it);
+  pushLoose(z);
+  }
+
+void ZoneIndex::clear() {
+  slots.clear();
+  tree.clear();
+  loose.clear();
+  bvh.clear();
+  holes   = 0;
+  dynamic = 0;
+  }
+
+void ZoneIndex::update() {
+  if(needRebuild())
+    rebuild();
+  }
+
+bool ZoneIndex::needRebuild() const {
+  const size_t pending = loose.size()-dynamic;
+  if(pending>std::max<size_t>(16,tree.size()/8))
+    return true;
+  return holes>0 && holes*4>tree.size();
+  }
+
+void ZoneIndex::rebuild() {
+  std::vector<CollisionZone*> zn;
+  zn.reserve(tree.size()-holes+loose.size());
+  for(auto z:tree)
+    if(z!=nullptr)
+      zn.push_back(z);
+
+  std::vector<CollisionZone*> dyn;
+  for(auto z:loose) {
+    if(z->isDynamic())
+      dyn.push_back(z); else
+      zn.push_back(z);
+    }
+
+  std::vector<BoxTree::Box> boxes(zn.size());
+  for(size_t i=0; i<zn.size(); ++i) {
+    zn[i]->bbox(boxes[i].min,boxes[i].max);
+    boxes[i].id = uint32_t(i);
+    slots[zn[i]] = Slot{L_Tree,uint32_t(i)};
+    }
+  for(size_t i=0; i<dyn.size(); ++i)
+    slots[dyn[i]] = Slot{L_Loose,uint32_t(i)};
+
+  bvh.build(std::move(boxes));
+  tree  = std::move(zn);
+  loose = std::move(dyn);
+  holes = 0;
+  rebuilds++;
+  }
+
+void ZoneIndex::pushLoose(CollisionZone& z) {
+  slots[&z] = Slot{L_Loose,uint32_t(loose.size())};
+  loose.push_back(&z);
+  if(z.isDynamic())
+    dynamic++;
+  }
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include "boxtree.h"
+
+class CollisionZone;
+
+// broadphase for collision zones: static zones are kept in BoxTree, moved and new zones are tested linearly,
+// until next rebuild
+class ZoneIndex final {
+  public:
+    ZoneIndex() = default;
+
+    void     insert    (CollisionZone& z);
+    void     erase     (const CollisionZone& z);
+    void     invalidate(CollisionZone& z);
+    void     clear();
+    void     update();
+
+    size_t   size()         const { return slots.size(); }
+    uint32_t rebuildCount() const { return rebuilds;     }
+
+    // visits every zone, that may contain p; no exact test
+    template<class F>
+    void     find(const Tempest::Vec3& p, const F& f) const;
+
+  private:
+    enum Location : uint8_t {
+      L_Tree,
+      L_Loose,
+      };
+    struct Slot final {
+      Location loc = L_Loose;
+      uint32_t id  = 0;
+      };
+
+    bool     needRebuild() const;
+    void     rebuild();
+    void     pushLoose(CollisionZone& z);
+
+    std::unordered_map<const CollisionZone*,Slot> slots;
+    std::vector<CollisionZone*>                   tree;  // nullptr, for removed zones
+    std::vector<CollisionZone*>                   loose;
+    BoxTree                                       bvh;
+    size_t                                        holes    = 0;
+    size_t                                        dynamic  = 0; // loose zones, that change size every tick
+    uint32_t                                      rebuilds = 0;
+  };
+
+template<class F>
+void ZoneIndex::find(const Tempest::Vec3& p, const F& f) const {
+  bvh.find(p,[this,&f](uint32_t id){
+    if(auto z = tree[id])
+      f(*z);
+    });
+  for(auto z:loose)
+    f(*z);
+  }